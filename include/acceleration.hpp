@@ -0,0 +1,210 @@
+#pragma once
+#include "geometry.hpp"
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+// Gemeinsame Bausteine aller Beschleunigungsstrukturen (KD-Tree, BVH, Pakete)
+
+struct BoundingBox
+{
+    Point3 min, max;
+
+    BoundingBox() : min(1e30f, 1e30f, 1e30f), max(-1e30f, -1e30f, -1e30f) {}
+    BoundingBox(const Point3 &min, const Point3 &max) : min(min), max(max) {}
+
+    void expand(const Point3 &point);
+    void expand(const BoundingBox &box);
+    bool intersect(const Ray &ray, float &t_min, float &t_max) const;
+    float surface_area() const;
+    int longest_axis() const;
+};
+
+// Verzweigungsfreier Slab-Test mit vorberechnetem Kehrwert der Strahlrichtung.
+// Alle drei Achsen werden gleichzeitig geschnitten; die vierte SIMD-Spur
+// liefert das Startintervall [0, 1e30].
+inline bool BoundingBox::intersect(const Ray &ray, float &t_min, float &t_max) const
+{
+#if defined(__SSE2__)
+    const __m128 origin = _mm_setr_ps(ray.origin.x, ray.origin.y, ray.origin.z, 0.0f);
+    const __m128 inv_dir = _mm_setr_ps(ray.inv_direction.x, ray.inv_direction.y, ray.inv_direction.z, 1.0f);
+    const __m128 lo = _mm_setr_ps(min.x, min.y, min.z, 0.0f);
+    const __m128 hi = _mm_setr_ps(max.x, max.y, max.z, 1e30f);
+
+    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(lo, origin), inv_dir);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(hi, origin), inv_dir);
+    __m128 t_near = _mm_min_ps(t0, t1);
+    __m128 t_far = _mm_max_ps(t0, t1);
+
+    // Achsenparallele Strahlen (Kehrwert ±max): nur prüfen, ob der Ursprung in der
+    // Schicht liegt, auch auf ihrem Rand. Sonst ergäbe 0 * max bei einer flachen Box
+    // mit dem Ursprung in ihrer Ebene das leere Intervall [0, 0].
+    const __m128 abs_inv = _mm_and_ps(inv_dir, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+    const __m128 parallel = _mm_cmpeq_ps(abs_inv, _mm_set1_ps(std::numeric_limits<float>::max()));
+    const __m128 inside = _mm_and_ps(_mm_cmpge_ps(origin, lo), _mm_cmple_ps(origin, hi));
+    const __m128 far_away = _mm_set1_ps(1e30f);
+    const __m128 slab_near = _mm_or_ps(_mm_and_ps(inside, _mm_sub_ps(_mm_setzero_ps(), far_away)),
+                                       _mm_andnot_ps(inside, far_away));
+    const __m128 slab_far = _mm_sub_ps(_mm_setzero_ps(), slab_near);
+    t_near = _mm_or_ps(_mm_and_ps(parallel, slab_near), _mm_andnot_ps(parallel, t_near));
+    t_far = _mm_or_ps(_mm_and_ps(parallel, slab_far), _mm_andnot_ps(parallel, t_far));
+
+    // Horizontales Maximum der Eintritts- und Minimum der Austrittsdistanzen
+    t_near = _mm_max_ps(t_near, _mm_shuffle_ps(t_near, t_near, _MM_SHUFFLE(2, 3, 0, 1)));
+    t_near = _mm_max_ps(t_near, _mm_shuffle_ps(t_near, t_near, _MM_SHUFFLE(1, 0, 3, 2)));
+    t_far = _mm_min_ps(t_far, _mm_shuffle_ps(t_far, t_far, _MM_SHUFFLE(2, 3, 0, 1)));
+    t_far = _mm_min_ps(t_far, _mm_shuffle_ps(t_far, t_far, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    t_min = _mm_cvtss_f32(t_near);
+    t_max = _mm_cvtss_f32(t_far);
+#else
+    // Skalarer Fallback: das Vorzeichen wählt die nahe und ferne Ebene direkt aus.
+    // Achsenparallele Strahlen prüfen nur, ob der Ursprung in der Schicht liegt.
+    const float origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    const float inv[3] = {ray.inv_direction.x, ray.inv_direction.y, ray.inv_direction.z};
+    const float lo[3] = {min.x, min.y, min.z};
+    const float hi[3] = {max.x, max.y, max.z};
+
+    t_min = 0.0f;
+    t_max = 1e30f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (std::abs(inv[axis]) == std::numeric_limits<float>::max())
+        {
+            if (origin[axis] < lo[axis] || origin[axis] > hi[axis])
+                return false;
+            continue;
+        }
+        float t0 = ((ray.sign[axis] ? hi[axis] : lo[axis]) - origin[axis]) * inv[axis];
+        float t1 = ((ray.sign[axis] ? lo[axis] : hi[axis]) - origin[axis]) * inv[axis];
+        t_min = std::max(t_min, t0);
+        t_max = std::min(t_max, t1);
+    }
+#endif
+
+    return t_min <= t_max && t_max > 0.001f; // Mindest-Distanz
+}
+
+// Strahlenbündel im SoA-Layout mit eigener Maximaldistanz pro Strahl
+struct RayStream
+{
+    std::vector<float> ox, oy, oz;
+    std::vector<float> dx, dy, dz;
+    std::vector<float> t_max;
+
+    size_t size() const { return ox.size(); }
+    void clear();
+    void reserve(size_t n);
+    void push_back(const Ray &ray, float max_t = 1e30f);
+    // Richtungen kommen aus Ray und sind bereits normiert
+    Ray ray(size_t i) const { return Ray::with_unit_direction(Point3(ox[i], oy[i], oz[i]), Vector3(dx[i], dy[i], dz[i])); }
+};
+
+// Ergebnisse einer Stream-Anfrage, Index i gehört zu Strahl i
+struct HitStream
+{
+    std::vector<float> t;
+    std::vector<const Triangle *> triangle; // nullptr = kein Treffer
+    std::vector<Vector3> normal;            // Normale im Weltkoordinatensystem
+
+    size_t size() const { return t.size(); }
+    void resize(size_t n);
+};
+
+// Nächster Treffer mit Normale im Weltkoordinatensystem
+struct Hit
+{
+    float t = 1e30f;
+    const Triangle *triangle = nullptr;
+    Vector3 normal;
+};
+
+// Zähler der Einzelstrahl-Traversierung, pro Thread. Der KD-Tree zählt besuchte
+// Knoten und getestete Dreiecke (auch für Schattenstrahlen); die Differenz vor
+// und nach einem Pixel ergibt dessen Aufwand.
+struct TraversalCounters
+{
+    uint64_t nodes = 0;
+    uint64_t triangles = 0;
+};
+
+inline thread_local TraversalCounters traversal_counters;
+
+// Traversierungsstapel mit N Einträgen auf dem Stack. Breite Bäume legen pro
+// Ebene bis zu sieben Geschwister ab; läuft das feste Feld bei entarteten,
+// sehr tiefen Bäumen über, wandern weitere Einträge in einen Vektor. Der wird
+// zuerst wieder abgebaut, die LIFO-Reihenfolge bleibt also erhalten.
+template <typename T, int N>
+class TraversalStack
+{
+private:
+    T fixed[N];
+    int sp = 0;
+    std::vector<T> spill;
+
+public:
+    bool empty() const { return sp == 0; }
+
+    void push(const T &entry)
+    {
+        if (sp < N)
+            fixed[sp++] = entry;
+        else
+            spill.push_back(entry);
+    }
+
+    T pop()
+    {
+        if (!spill.empty())
+        {
+            T entry = spill.back();
+            spill.pop_back();
+            return entry;
+        }
+        return fixed[--sp];
+    }
+};
+
+// Gemeinsame Schnittstelle aller Beschleunigungsstrukturen
+class Accelerator
+{
+public:
+    virtual ~Accelerator() = default;
+
+    virtual void build(const std::vector<Triangle> &triangles) = 0;
+
+    // Nächster Treffer eines einzelnen Strahls
+    virtual bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const = 0;
+
+    // Nächster Treffer samt Normale; Instanzen liefern die transformierte Normale
+    virtual bool intersect_hit(const Ray &ray, Hit &hit) const;
+
+    // Beliebiger Treffer vor t_max (Schattenstrahlen)
+    virtual bool occluded(const Ray &ray, float t_max) const;
+
+    // Wie occluded, liefert zusätzlich ein verdeckendes Dreieck für Verdecker-Caches.
+    // occluder bleibt nullptr, wenn die Struktur kein Dreieck im Weltraum angeben
+    // kann (Instanzen).
+    virtual bool find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const;
+
+    // Stream-Anfragen: nächster Treffer bzw. Verdeckung für alle Strahlen des Bündels.
+    // Die Standardimplementierung fragt jeden Strahl einzeln an. occluder_stream
+    // liefert wie find_occluder beides: ob der Strahl verdeckt ist, entscheidet
+    // allein occluded, der Verdecker kann auch dann nullptr sein.
+    virtual void intersect_stream(const RayStream &rays, HitStream &hits) const;
+    virtual void occluded_stream(const RayStream &rays, std::vector<char> &occluded) const;
+    virtual void occluder_stream(const RayStream &rays, std::vector<char> &occluded,
+                                 std::vector<const Triangle *> &occluders) const;
+
+    // Bounding Box aller enthaltenen Dreiecke
+    virtual BoundingBox bounds() const = 0;
+
+    virtual void print_stats() const {}
+    virtual const char *name() const = 0;
+};
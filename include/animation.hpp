@@ -0,0 +1,52 @@
+#pragma once
+#include "camera.hpp"
+#include "image.hpp"
+#include "light.hpp"
+#include "acceleration.hpp"
+#include "raytracer.hpp"
+#include "thread_pool.hpp"
+#include "progress.hpp"
+#include <vector>
+#include <string>
+#include <future>
+
+// Schlüsselbild einer Kamerafahrt
+struct Keyframe
+{
+    Camera camera;
+    Light light;
+};
+
+// Bild frame von frame_count, linear zwischen den gleichmäßig verteilten
+// Schlüsselbildern. Bei frame_count == keyframes.size() trifft jedes Bild
+// genau ein Schlüsselbild.
+Keyframe interpolate_keyframes(const std::vector<Keyframe> &keyframes, int frame, int frame_count);
+
+// Rendert viele Bilder mit derselben Beschleunigungsstruktur. Thread-Pool und
+// die beiden Bildpuffer bleiben über alle Bilder erhalten; während ein Bild
+// gerendert wird, schreibt ein Pool-Thread das vorherige.
+class AnimationRenderer
+{
+private:
+    int width, height;
+    PathSettings path_settings;
+    ThreadPool pool;
+    Image frames[2];
+    std::future<void> encoding[2];
+
+    void render_frame(const Accelerator &accel, const Camera &cam, const LightTree &lights, Image &img,
+                      ProgressReporter &progress);
+
+public:
+    // thread_count 0 = ein Thread pro Hardware-Thread
+    AnimationRenderer(int w, int h, size_t thread_count = 0);
+
+    void set_path_settings(const PathSettings &settings) { path_settings = settings; }
+
+    // output_pattern im printf-Format mit der Bildnummer, z. B. "frame_%04d.png":
+    // genau ein %d (Flags, Breite erlaubt), sonst nur %%, andernfalls wirft render
+    // std::runtime_error. Das Format folgt der Endung (siehe Image::save), "-"
+    // schreibt alle Bilder nacheinander roh auf die Standardausgabe
+    void render(const Accelerator &accel, const std::vector<Keyframe> &keyframes, int frame_count,
+                const std::string &output_pattern);
+};
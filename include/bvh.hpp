@@ -0,0 +1,101 @@
+#pragma once
+#include "geometry.hpp"
+#include "acceleration.hpp"
+#include <vector>
+#include <cstdint>
+
+// Knoten der binären BVH; Kinder liegen hinter dem Elternknoten im Array
+struct BVHNode
+{
+    BoundingBox bbox;
+    uint32_t left_first; // Innerer Knoten: Index des linken Kindes (rechts = +1), Blatt: erstes Dreieck
+    uint32_t count;      // Anzahl Dreiecke im Blatt, 0 = innerer Knoten
+
+    bool is_leaf() const { return count > 0; }
+};
+
+// Binäre BVH mit SAH-Binning
+class BVH : public Accelerator
+{
+private:
+    std::vector<BVHNode> nodes;
+    std::vector<const Triangle *> triangles; // nach Blättern sortiert
+    int max_triangles_per_leaf;
+    bool verbose;
+
+    // Für Refitting: Lage der Dreiecke beim Aufbau (wird nur verglichen, nie
+    // dereferenziert) und SAH-Kosten direkt nach dem Aufbau
+    const Triangle *source_data = nullptr;
+    size_t source_size = 0;
+    float build_cost = 0.0f;
+    float rebuild_threshold = 1.5f;
+
+    struct BuildPrimitive
+    {
+        BoundingBox bbox;
+        Point3 centroid;
+        const Triangle *triangle;
+    };
+
+    void build_recursive(uint32_t node_index, std::vector<BuildPrimitive> &prims, uint32_t first, uint32_t count, int depth);
+    bool same_source(const std::vector<Triangle> &input) const;
+
+public:
+    BVH(int max_triangles_per_leaf = 4, bool verbose = true);
+    void build(const std::vector<Triangle> &triangles) override;
+    bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const override;
+    bool find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const override;
+    BoundingBox bounds() const override { return nodes.empty() ? BoundingBox() : nodes[0].bbox; }
+    void print_stats() const override;
+    const char *name() const override { return "BVH"; }
+
+    // Animation: input ist der beim Aufbau übergebene Vektor, seine Eckpunkte dürfen
+    // sich ändern, die Topologie (Anzahl und Reihenfolge der Dreiecke) nicht.
+    // Liegen die Dreiecke nicht mehr an derselben Stelle (Vektor kopiert oder
+    // umgezogen) oder hat sich ihre Anzahl geändert, wird stattdessen neu gebaut.
+    // refit() passt nur die Knotenboxen von unten nach oben an (O(N)).
+    void refit(const std::vector<Triangle> &input);
+    // Refit und Qualitätskontrolle: steigen die SAH-Kosten über rebuild_threshold mal
+    // die Kosten nach dem Aufbau, wird komplett neu gebaut. Liefert true bei Neuaufbau.
+    bool update(const std::vector<Triangle> &input);
+    void set_rebuild_threshold(float threshold) { rebuild_threshold = threshold; }
+    float sah_cost() const;
+    float quality() const { return build_cost > 0.0f ? sah_cost() / build_cost : 1.0f; }
+
+    const std::vector<BVHNode> &get_nodes() const { return nodes; }
+    const std::vector<const Triangle *> &get_triangles() const { return triangles; }
+};
+
+// 8-fach breiter Knoten: Kindboxen im SoA-Layout, ein AVX-Durchlauf testet alle acht
+struct alignas(32) BVH8Node
+{
+    float bounds[2][3][8];  // [min/max][Achse][Kind]
+    uint32_t child[8];      // Innerer Knoten: Knotenindex, Blatt: erstes Dreieck
+    uint32_t count[8];      // Dreiecke im Blatt, 0 = innerer Knoten
+    uint32_t child_count;   // Belegte Slots, leere Slots haben eine invertierte Box
+};
+
+// Breite BVH, entsteht durch Zusammenfassen einer binären SAH-BVH
+class BVH8 : public Accelerator
+{
+private:
+    std::vector<BVH8Node> nodes;
+    std::vector<const Triangle *> triangles;
+    BoundingBox root_bbox;
+    bool verbose;
+
+    uint32_t collapse(const std::vector<BVHNode> &binary, uint32_t binary_index);
+    int intersect_children(const BVH8Node &node, const Ray &ray, float max_t, float *t_near) const;
+
+public:
+    BVH8(bool verbose = true) : verbose(verbose) {}
+    void build(const std::vector<Triangle> &triangles) override;
+    bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const override;
+    bool find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const override;
+    BoundingBox bounds() const override { return root_bbox; }
+    void print_stats() const override;
+    const char *name() const override { return "BVH8"; }
+
+    const std::vector<BVH8Node> &get_nodes() const { return nodes; }
+    const std::vector<const Triangle *> &get_triangles() const { return triangles; }
+};
@@ -1,21 +1,93 @@
 #pragma once
 #include "geometry.hpp"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 struct Camera {
     Point3 eye;
     Vector3 view;
     float width, height;
     int width_px, height_px;
 
+    // Orthonormalbasis (right, up, view) und Bildebene im Abstand 1 vor dem Auge:
+    // Richtung zum Pixelpunkt (fx, fy) = corner + step_x * fx + step_y * fy
+    Vector3 right, up;
+    Vector3 corner, step_x, step_y;
+
     Camera(Point3 eye, Vector3 view, float width, float height, int wp, int hp)
-        : eye(eye), view(view.normalize()), width(width), height(height), width_px(wp), height_px(hp) {}
+        : eye(eye), view(view.normalize()), width(width), height(height), width_px(wp), height_px(hp) {
+        // Oben ist +y; beim Blick senkrecht nach oben oder unten zeigt -z nach oben
+        Vector3 world_up = std::abs(this->view.y) > 0.999f ? Vector3(0, 0, -1) : Vector3(0, 1, 0);
+        right = this->view.cross(world_up).normalize();
+        up = right.cross(this->view);
+
+        step_x = right * (width / wp);
+        step_y = up * (height / hp);
+        corner = this->view - right * (0.5f * width) - up * (0.5f * height);
+    }
 
     Ray get_ray(int x, int y) const {
-        float px = ((x + 0.5f) / width_px - 0.5f) * width;
-        float py = ((y + 0.5f) / height_px - 0.5f) * height;
-        Vector3 right = Vector3(1, 0, 0);  // vereinfachte Annahme
-        Vector3 up = Vector3(0, 1, 0);
-        Vector3 pixel_pos = eye + view + right * px + up * py;
-        return Ray(eye, pixel_pos - eye);
+        return get_ray(x, y, 0.5f, 0.5f);
+    }
+
+    // Strahl durch den Punkt (sx, sy) in [0, 1) innerhalb des Pixels
+    Ray get_ray(int x, int y, float sx, float sy) const {
+        float dx, dy, dz;
+        row_directions(y, x, 1, &dx, &dy, &dz, sx, sy);
+        return Ray::with_unit_direction(eye, Vector3(dx, dy, dz));
+    }
+
+    // Normierte Richtungen für count Pixel ab x0 in Zeile y im SoA-Layout, je
+    // Pixel am Punkt (sx, sy). Vier Pixel pro SSE-Schritt; get_ray läuft über
+    // denselben Code, die Strahlen sind also bitgleich.
+    void row_directions(int y, int x0, int count, float *dx, float *dy, float *dz,
+                        float sx = 0.5f, float sy = 0.5f) const {
+        const Vector3 row = corner + step_y * (y + sy);
+#if defined(__SSE2__)
+        const __m128 row_x = _mm_set1_ps(row.x), row_y = _mm_set1_ps(row.y), row_z = _mm_set1_ps(row.z);
+        const __m128 step_xx = _mm_set1_ps(step_x.x), step_xy = _mm_set1_ps(step_x.y), step_xz = _mm_set1_ps(step_x.z);
+        const __m128 offset = _mm_set1_ps(sx);
+        const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+        for (int k = 0; k < count; k += 4) {
+            // Pixelspalte als Ganzzahl umwandeln, damit fx nicht von der Position in der Gruppe abhängt
+            __m128 fx = _mm_add_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x0 + k), lanes)), offset);
+            __m128 vx = _mm_add_ps(row_x, _mm_mul_ps(step_xx, fx));
+            __m128 vy = _mm_add_ps(row_y, _mm_mul_ps(step_xy, fx));
+            __m128 vz = _mm_add_ps(row_z, _mm_mul_ps(step_xz, fx));
+
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+            vx = _mm_div_ps(vx, length);
+            vy = _mm_div_ps(vy, length);
+            vz = _mm_div_ps(vz, length);
+
+            if (count - k >= 4) {
+                _mm_storeu_ps(dx + k, vx);
+                _mm_storeu_ps(dy + k, vy);
+                _mm_storeu_ps(dz + k, vz);
+            } else {
+                alignas(16) float tx[4], ty[4], tz[4];
+                _mm_store_ps(tx, vx);
+                _mm_store_ps(ty, vy);
+                _mm_store_ps(tz, vz);
+                for (int i = 0; i < count - k; ++i) {
+                    dx[k + i] = tx[i];
+                    dy[k + i] = ty[i];
+                    dz[k + i] = tz[i];
+                }
+            }
+        }
+#else
+        for (int k = 0; k < count; ++k) {
+            float fx = static_cast<float>(x0 + k) + sx;
+            Vector3 d = Vector3(row.x + step_x.x * fx, row.y + step_x.y * fx, row.z + step_x.z * fx);
+            float length = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+            dx[k] = d.x / length;
+            dy[k] = d.y / length;
+            dz[k] = d.z / length;
+        }
+#endif
     }
 };
@@ -0,0 +1,44 @@
+#pragma once
+#include "geometry.hpp"
+#include "acceleration.hpp"
+#include "bvh.hpp"
+#include <vector>
+#include <cstdint>
+
+// Komprimierter 8-fach Knoten: Kindboxen als 8-Bit-Gitterkoordinaten relativ zur
+// Knotenbox. Die Zellgröße ist eine Zweierpotenz, dadurch ist q * 2^e exakt und
+// die Dekodierung liefert beim Aufbau und in der Traversierung dieselben Werte.
+struct CompressedBVH8Node
+{
+    float origin[3];          // Untere Ecke der Knotenbox
+    int8_t exponent[3];       // Zellgröße pro Achse = 2^exponent
+    uint8_t inner_mask;       // Bit k: Kind k ist ein innerer Knoten
+    uint32_t child_base;      // Innere Kinder liegen ab hier zusammenhängend im Array
+    uint32_t triangle_base;   // Dreiecke aller Blatt-Kinder liegen ab hier zusammenhängend
+    uint8_t q_min[3][8];      // [Achse][Kind], abgerundet
+    uint8_t q_max[3][8];      // [Achse][Kind], aufgerundet
+    uint8_t leaf_offset[8];   // Erstes Dreieck relativ zu triangle_base
+    uint8_t leaf_count[8];    // 0 = innerer Knoten oder leerer Slot
+};
+
+// Breite BVH mit quantisierten Knoten, etwa ein Drittel des Speichers der BVH8.
+// Die Rundung ist konservativ, es wird also nie ein Treffer verpasst.
+class CompressedBVH8 : public Accelerator
+{
+private:
+    std::vector<CompressedBVH8Node> nodes;
+    std::vector<const Triangle *> triangles;
+    BoundingBox root_bbox;
+
+    void compress(const std::vector<BVH8Node> &wide, const std::vector<const Triangle *> &wide_triangles,
+                  uint32_t wide_index, uint32_t out_index);
+    int intersect_children(const CompressedBVH8Node &node, const Ray &ray, float max_t, float *t_near) const;
+
+public:
+    void build(const std::vector<Triangle> &triangles) override;
+    bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const override;
+    bool find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const override;
+    BoundingBox bounds() const override { return root_bbox; }
+    void print_stats() const override;
+    const char *name() const override { return "Compressed BVH8"; }
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "camera.hpp"
+#include "image.hpp"
+#include "light.hpp"
+#include "acceleration.hpp"
+#include "raytracer.hpp"
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+
+// Kachel im Bild, y = 0 ist wie bei set_pixel die unterste Zeile.
+// width == 0 beendet einen Worker.
+struct TileRequest
+{
+    int32_t x, y;
+    int32_t width, height;
+};
+
+// Worker-Schleife: liest Kacheln von in_fd, rendert sie wie render_kdtree und
+// schickt die Kachel gefolgt von width * height RGB-Pixeln (zeilenweise) an out_fd.
+void run_tile_worker(int in_fd, int out_fd, const Accelerator &accel, const Camera &cam,
+                     const LightTree &lights, const PathSettings &settings = PathSettings());
+
+// Verteilt ein Bild in Kacheln auf lokale Worker-Prozesse, die über Pipes
+// angebunden sind. Jeder Worker bekommt eine Kachel nach der anderen; stirbt
+// einer, gehen seine offene Kachel zurück in die Warteschlange und die übrigen
+// Worker übernehmen. Nur POSIX (fork, pipe, poll).
+class TileCoordinator
+{
+private:
+    int width, height, tile_size;
+
+    void render(Image &img, int worker_count, const std::function<void(int, int)> &child_main);
+
+public:
+    TileCoordinator(int w, int h, int tile_size = 64);
+
+    // Worker per fork: worker(in_fd, out_fd) läuft im Kindprozess und teilt sich
+    // die bereits aufgebaute Struktur copy-on-write mit dem Koordinator
+    void render_forked(Image &img, int worker_count, const std::function<void(int, int)> &worker);
+
+    // Worker per exec: command wird um "<in_fd> <out_fd>" ergänzt, der Worker lädt
+    // die Szene und baut die Struktur selbst
+    void render_spawned(Image &img, int worker_count, const std::vector<std::string> &command);
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include "camera.hpp"
+#include "geometry.hpp"
+#include "acceleration.hpp"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// Erster Treffer pro Pixel (Dreieck, t, Normale). Solange Kamera und Geometrie
+// gleich bleiben, lassen sich Lichter und Materialien ändern, ohne die
+// Primärstrahlen erneut zu verfolgen; nur Schattierung, Schatten und
+// Reflexionen laufen neu. Die Dreiecke werden über ihren Index in die
+// MaterialTable schattiert, Materialänderungen wirken also sofort.
+class GBuffer
+{
+private:
+    // Schlüssel, für den der Inhalt gilt
+    const Accelerator *accel = nullptr;
+    Point3 eye;
+    Vector3 view;
+    float cam_width = 0.0f, cam_height = 0.0f;
+    int cam_width_px = 0, cam_height_px = 0;
+    int width = 0, height = 0; // Bildgröße des Renderers, bestimmt die Pixelindizes
+    bool complete = false;
+
+    std::vector<float> t;
+    std::vector<const Triangle *> triangle; // nullptr = Hintergrund
+    std::vector<Vector3> normal;
+
+public:
+    // true, wenn der Puffer vollständig für diese Struktur, Kamera und
+    // Bildgröße (image_width x image_height des Renderers) gefüllt ist
+    bool matches(const Accelerator &structure, const Camera &cam, int image_width, int image_height) const
+    {
+        return complete && accel == &structure && width == image_width && height == image_height &&
+               cam_width_px == cam.width_px && cam_height_px == cam.height_px &&
+               cam_width == cam.width && cam_height == cam.height &&
+               eye.x == cam.eye.x && eye.y == cam.eye.y && eye.z == cam.eye.z &&
+               view.x == cam.view.x && view.y == cam.view.y && view.z == cam.view.z;
+    }
+
+    // Bereitet das Füllen vor; gültig erst nach mark_complete(). Der Puffer
+    // wird nach der Bildgröße des Renderers angelegt, nicht nach der Kamera,
+    // denn der Renderer indiziert mit y * image_width + x.
+    void reset(const Accelerator &structure, const Camera &cam, int image_width, int image_height)
+    {
+        accel = &structure;
+        eye = cam.eye;
+        view = cam.view;
+        cam_width = cam.width;
+        cam_height = cam.height;
+        cam_width_px = cam.width_px;
+        cam_height_px = cam.height_px;
+        width = image_width;
+        height = image_height;
+        complete = false;
+
+        size_t n = static_cast<size_t>(width) * static_cast<size_t>(height);
+        t.resize(n);
+        triangle.resize(n);
+        normal.resize(n);
+    }
+
+    void mark_complete() { complete = true; }
+
+    // Nach Änderungen an der Geometrie (Refit, neue Szene in derselben Struktur)
+    void invalidate() { complete = false; }
+
+    void store(uint32_t pixel, const Hit &hit)
+    {
+        t[pixel] = hit.t;
+        triangle[pixel] = hit.triangle;
+        normal[pixel] = hit.normal;
+    }
+
+    void load(uint32_t pixel, Hit &hit) const
+    {
+        hit.t = t[pixel];
+        hit.triangle = triangle[pixel];
+        hit.normal = normal[pixel];
+    }
+
+    // Abschnitt aufeinanderfolgender Pixel aus einem HitStream übernehmen bzw. zurückgeben
+    void store(uint32_t first_pixel, const HitStream &hits)
+    {
+        std::copy(hits.t.begin(), hits.t.end(), t.begin() + first_pixel);
+        std::copy(hits.triangle.begin(), hits.triangle.end(), triangle.begin() + first_pixel);
+        std::copy(hits.normal.begin(), hits.normal.end(), normal.begin() + first_pixel);
+    }
+
+    void load(uint32_t first_pixel, uint32_t count, HitStream &hits) const
+    {
+        hits.resize(count);
+        std::copy(t.begin() + first_pixel, t.begin() + first_pixel + count, hits.t.begin());
+        std::copy(triangle.begin() + first_pixel, triangle.begin() + first_pixel + count, hits.triangle.begin());
+        std::copy(normal.begin() + first_pixel, normal.begin() + first_pixel + count, hits.normal.begin());
+    }
+};
@@ -2,6 +2,7 @@
 #include <vector>
 #include <cmath>
 #include <limits>
+#include <cstdint>
 
 struct Vector3 {
     float x, y, z;
@@ -12,6 +13,8 @@ struct Vector3 {
     Vector3 operator*(float s) const { return Vector3(x*s, y*s, z*s); }
     Vector3 operator/(float s) const { return Vector3(x/s, y/s, z/s); }
 
+    float operator[](int axis) const { return axis == 0 ? x : (axis == 1 ? y : z); }
+
     float dot(const Vector3& v) const { return x*v.x + y*v.y + z*v.z; }
     Vector3 cross(const Vector3& v) const {
         return Vector3(
@@ -26,17 +29,120 @@ struct Vector3 {
 
 using Point3 = Vector3;
 
+// Affine Transformation als 3x4-Matrix (linearer Teil | Translation)
+struct Transform {
+    float m[3][4];
+
+    Transform() {
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 4; ++c)
+                m[r][c] = (r == c) ? 1.0f : 0.0f;
+    }
+
+    static Transform translate(const Vector3& t) {
+        Transform tr;
+        tr.m[0][3] = t.x; tr.m[1][3] = t.y; tr.m[2][3] = t.z;
+        return tr;
+    }
+    static Transform scale(const Vector3& s) {
+        Transform tr;
+        tr.m[0][0] = s.x; tr.m[1][1] = s.y; tr.m[2][2] = s.z;
+        return tr;
+    }
+    // Drehung um die Y-Achse (Winkel im Bogenmaß)
+    static Transform rotate_y(float angle) {
+        Transform tr;
+        float c = std::cos(angle), s = std::sin(angle);
+        tr.m[0][0] = c;  tr.m[0][2] = s;
+        tr.m[2][0] = -s; tr.m[2][2] = c;
+        return tr;
+    }
+
+    Transform operator*(const Transform& o) const {
+        Transform r;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                r.m[i][j] = m[i][0] * o.m[0][j] + m[i][1] * o.m[1][j] + m[i][2] * o.m[2][j] + (j == 3 ? m[i][3] : 0.0f);
+            }
+        }
+        return r;
+    }
+
+    Point3 apply_point(const Point3& p) const {
+        return Point3(m[0][0]*p.x + m[0][1]*p.y + m[0][2]*p.z + m[0][3],
+                      m[1][0]*p.x + m[1][1]*p.y + m[1][2]*p.z + m[1][3],
+                      m[2][0]*p.x + m[2][1]*p.y + m[2][2]*p.z + m[2][3]);
+    }
+    Vector3 apply_vector(const Vector3& v) const {
+        return Vector3(m[0][0]*v.x + m[0][1]*v.y + m[0][2]*v.z,
+                       m[1][0]*v.x + m[1][1]*v.y + m[1][2]*v.z,
+                       m[2][0]*v.x + m[2][1]*v.y + m[2][2]*v.z);
+    }
+    // Multiplikation mit dem transponierten linearen Teil (Normalen mit der Inversen)
+    Vector3 apply_transposed(const Vector3& v) const {
+        return Vector3(m[0][0]*v.x + m[1][0]*v.y + m[2][0]*v.z,
+                       m[0][1]*v.x + m[1][1]*v.y + m[2][1]*v.z,
+                       m[0][2]*v.x + m[1][2]*v.y + m[2][2]*v.z);
+    }
+
+    Transform inverse() const {
+        Transform inv;
+        float det = m[0][0] * (m[1][1]*m[2][2] - m[1][2]*m[2][1])
+                  - m[0][1] * (m[1][0]*m[2][2] - m[1][2]*m[2][0])
+                  + m[0][2] * (m[1][0]*m[2][1] - m[1][1]*m[2][0]);
+        float inv_det = 1.0f / det;
+        inv.m[0][0] =  (m[1][1]*m[2][2] - m[1][2]*m[2][1]) * inv_det;
+        inv.m[0][1] = -(m[0][1]*m[2][2] - m[0][2]*m[2][1]) * inv_det;
+        inv.m[0][2] =  (m[0][1]*m[1][2] - m[0][2]*m[1][1]) * inv_det;
+        inv.m[1][0] = -(m[1][0]*m[2][2] - m[1][2]*m[2][0]) * inv_det;
+        inv.m[1][1] =  (m[0][0]*m[2][2] - m[0][2]*m[2][0]) * inv_det;
+        inv.m[1][2] = -(m[0][0]*m[1][2] - m[0][2]*m[1][0]) * inv_det;
+        inv.m[2][0] =  (m[1][0]*m[2][1] - m[1][1]*m[2][0]) * inv_det;
+        inv.m[2][1] = -(m[0][0]*m[2][1] - m[0][1]*m[2][0]) * inv_det;
+        inv.m[2][2] =  (m[0][0]*m[1][1] - m[0][1]*m[1][0]) * inv_det;
+        Vector3 t = inv.apply_vector(Vector3(m[0][3], m[1][3], m[2][3]));
+        inv.m[0][3] = -t.x; inv.m[1][3] = -t.y; inv.m[2][3] = -t.z;
+        return inv;
+    }
+};
+
 struct Ray {
     Point3 origin;
     Vector3 direction;
-    Ray(Point3 origin, Vector3 direction) : origin(origin), direction(direction.normalize()) {}
+    Vector3 inv_direction; // 1/direction, für den Slab-Test vorberechnet
+    int sign[3];           // 1, wenn die Richtung entlang der Achse negativ ist
+
+    Ray(Point3 origin, Vector3 direction) : Ray(origin, direction.normalize(), UnitDirection()) {}
+
+    // Richtung ist bereits normiert (Kamera, Strahlenbündel): spart Wurzel und Division
+    static Ray with_unit_direction(Point3 origin, Vector3 unit_direction) {
+        return Ray(origin, unit_direction, UnitDirection());
+    }
+
+private:
+    struct UnitDirection {};
+
+    Ray(Point3 origin, Vector3 unit_direction, UnitDirection) : origin(origin), direction(unit_direction) {
+        inv_direction = Vector3(reciprocal(direction.x), reciprocal(direction.y), reciprocal(direction.z));
+        sign[0] = inv_direction.x < 0;
+        sign[1] = inv_direction.y < 0;
+        sign[2] = inv_direction.z < 0;
+    }
+
+    // Achsenparallele Richtungen bekommen einen endlichen Kehrwert statt inf,
+    // damit 0 * inv im Slab-Test kein NaN liefert
+    static float reciprocal(float d) {
+        return std::abs(d) > 1e-8f ? 1.0f / d : std::copysign(std::numeric_limits<float>::max(), d);
+    }
 };
 
 struct Triangle {
     Point3 v0, v1, v2;
-    Vector3 color;
+    uint16_t material; // Index in die MaterialTable (material.hpp)
+
+    Triangle(Point3 a, Point3 b, Point3 c, uint16_t material = 0) : v0(a), v1(b), v2(c), material(material) {}
 
-    Triangle(Point3 a, Point3 b, Point3 c, Vector3 color) : v0(a), v1(b), v2(c), color(color) {}
+    Vector3 normal() const { return (v1 - v0).cross(v2 - v0).normalize(); }
 
     bool intersect(const Ray& ray, float& t) const {
         const float EPS = 1e-6;
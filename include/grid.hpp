@@ -0,0 +1,45 @@
+#pragma once
+#include "geometry.hpp"
+#include "acceleration.hpp"
+#include <vector>
+#include <cstdint>
+
+// Eine Gitterebene: Zellen mit Dreieckslisten im CSR-Format
+struct GridLevel
+{
+    BoundingBox bbox;
+    int res[3] = {0, 0, 0};
+    Vector3 cell_size, inv_cell_size;
+    std::vector<uint32_t> cell_start;              // Zelle i: refs[cell_start[i] .. cell_start[i+1])
+    std::vector<const Triangle *> refs;
+    std::vector<int32_t> child;                    // Index des Untergitters oder -1 (nur oberste Ebene)
+
+    int cell_index(int x, int y, int z) const { return (z * res[1] + y) * res[0] + x; }
+};
+
+// Uniformes Gitter mit automatischer Auflösung und 3D-DDA-Traversierung.
+// Optional bekommen überfüllte Zellen ein eigenes Untergitter (zweistufiges Gitter).
+class Grid : public Accelerator
+{
+private:
+    GridLevel top;
+    std::vector<GridLevel> subgrids;
+    float density;
+    bool hierarchical;
+    int max_cell_triangles;
+
+    void build_level(GridLevel &level, const std::vector<const Triangle *> &triangles,
+                     const BoundingBox &bbox, float level_density) const;
+    bool traverse(const GridLevel &level, const Ray &ray, float t_enter, float t_exit, bool any_hit,
+                  float &best_t, const Triangle *&best_triangle) const;
+
+public:
+    // density: Zellen pro Dreieck, max_cell_triangles: ab dieser Belegung wird ein Untergitter gebaut
+    Grid(float density = 4.0f, bool hierarchical = false, int max_cell_triangles = 32);
+    void build(const std::vector<Triangle> &triangles) override;
+    bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const override;
+    bool find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const override;
+    BoundingBox bounds() const override { return top.bbox; }
+    void print_stats() const override;
+    const char *name() const override { return hierarchical ? "Grid (2-Level)" : "Grid"; }
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "geometry.hpp"
+#include "acceleration.hpp"
+#include "bvh.hpp"
+#include <vector>
+#include <cstdint>
+
+// Eine Instanz verweist auf eine geteilte Struktur im Objektraum
+struct Instance
+{
+    const Accelerator *blas;  // Bottom-Level-Struktur, wird nicht kopiert
+    Transform object_to_world;
+    Transform world_to_object;
+    BoundingBox world_bbox;
+};
+
+// Zweistufige Szene: Top-Level-BVH über Instanzen, Strahlen werden an der
+// Instanzgrenze in den Objektraum transformiert. Speicher und Aufbauzeit
+// wachsen mit der Anzahl verschiedener Netze, nicht mit der Anzahl Kopien.
+class InstancedScene : public Accelerator
+{
+private:
+    std::vector<Instance> instances;
+    std::vector<BVHNode> nodes;          // Blätter verweisen auf instance_order
+    std::vector<uint32_t> instance_order;
+
+    void build_recursive(uint32_t node_index, uint32_t first, uint32_t count);
+    Ray to_object_space(const Instance &instance, const Ray &ray, float &t_scale) const;
+
+public:
+    // Die Struktur muss bereits gebaut sein und länger leben als die Szene
+    void add_instance(const Accelerator &blas, const Transform &object_to_world);
+    void clear() { instances.clear(); nodes.clear(); instance_order.clear(); }
+    size_t instance_count() const { return instances.size(); }
+
+    // Baut nur die oberste Ebene; die Dreiecke liegen in den Instanzen,
+    // daher wird das Argument von build() ignoriert
+    void build_top_level();
+    void build(const std::vector<Triangle> &) override { build_top_level(); }
+
+    bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const override;
+    bool intersect_hit(const Ray &ray, Hit &hit) const override;
+    bool occluded(const Ray &ray, float t_max) const override;
+    bool find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const override
+    {
+        // Dreiecke liegen im Objektraum und taugen nicht für Weltraum-Caches
+        occluder = nullptr;
+        return occluded(ray, t_max);
+    }
+    BoundingBox bounds() const override { return nodes.empty() ? BoundingBox() : nodes[0].bbox; }
+    void print_stats() const override;
+    const char *name() const override { return "Instanced Scene"; }
+};
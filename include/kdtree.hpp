@@ -1,21 +1,9 @@
 #pragma once
 #include "geometry.hpp"
+#include "acceleration.hpp"
 #include <vector>
 #include <memory>
-
-struct BoundingBox
-{
-    Point3 min, max;
-
-    BoundingBox() : min(1e30f, 1e30f, 1e30f), max(-1e30f, -1e30f, -1e30f) {}
-    BoundingBox(const Point3 &min, const Point3 &max) : min(min), max(max) {}
-
-    void expand(const Point3 &point);
-    void expand(const BoundingBox &box);
-    bool intersect(const Ray &ray, float &t_min, float &t_max) const;
-    float surface_area() const;
-    int longest_axis() const;
-};
+#include <cstdint>
 
 struct KDNode
 {
@@ -29,7 +17,7 @@ struct KDNode
     KDNode() : axis(0), split_pos(0.0f), is_leaf(true) {}
 };
 
-class KDTree
+class KDTree : public Accelerator
 {
 private:
     std::unique_ptr<KDNode> root;
@@ -41,11 +29,26 @@ private:
     BoundingBox compute_triangle_bbox(const Triangle &tri) const;
     float evaluate_split(const std::vector<const Triangle *> &triangles, int axis, float pos) const;
     bool intersect_recursive(const KDNode *node, const Ray &ray, float &min_t, const Triangle *&hit_triangle) const;
+    bool occluded_recursive(const KDNode *node, const Ray &ray, float t_max, const Triangle *&occluder) const;
+
+    // Stream-Traversierung: alle aktiven Strahlen besuchen einen Knoten gemeinsam
+    void traverse_stream(const RayStream &rays, bool any_hit, std::vector<float> &best_t,
+                         std::vector<const Triangle *> &best_triangle) const;
+    void stream_recursive(const KDNode *node, const std::vector<Ray> &rays, const uint32_t *active, size_t count,
+                          bool any_hit, float *best_t, const Triangle **best_triangle,
+                          std::vector<std::vector<uint32_t>> &scratch, int depth) const;
 
 public:
     KDTree(int max_depth = 20, int max_triangles_per_leaf = 10);
-    void build(const std::vector<Triangle> &triangles);
-    bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const;
-    void print_stats() const;
+    void build(const std::vector<Triangle> &triangles) override;
+    bool intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const override;
+    bool find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const override;
+    void intersect_stream(const RayStream &rays, HitStream &hits) const override;
+    void occluded_stream(const RayStream &rays, std::vector<char> &occluded) const override;
+    void occluder_stream(const RayStream &rays, std::vector<char> &occluded,
+                         std::vector<const Triangle *> &occluders) const override;
+    BoundingBox bounds() const override { return root ? root->bbox : BoundingBox(); }
+    void print_stats() const override;
+    const char *name() const override { return "KD-Tree"; }
     void print_stats_recursive(const KDNode *node, int depth, int &leaf_count, int &total_triangles, int &max_depth) const;
 };
@@ -1,11 +1,99 @@
 #pragma once
 #include "geometry.hpp"
+#include "acceleration.hpp"
+#include <vector>
+#include <cstdint>
+
+enum class LightShape
+{
+    Point,
+    Rectangle, // position ist die Mitte, Kanten edge_u und edge_v
+    Sphere     // position ist der Mittelpunkt
+};
 
 struct Light
 {
     Point3 position;
     Vector3 color;
+    float intensity = 1.0f; // Skaliert den direkten Beitrag, bei vielen Lichtern < 1
+    float range = 0.0f;     // Abfall 1 / (1 + (d / range)^2), 0 = kein Abfall
+    LightShape shape = LightShape::Point;
+    Vector3 edge_u = {}, edge_v = {}; // Nur Rechteck
+    float radius = 0.0f;    // Nur Kugel
+    int samples = 1;        // Schattenstrahlen pro Treffer für Flächenlichter
+
+    // Flächenlichter für weiche Schatten, samples wird auf ein nx * ny Raster gerundet
+    static Light rectangle(const Point3 &center, const Vector3 &edge_u, const Vector3 &edge_v,
+                           const Vector3 &color, int samples = 16);
+    static Light sphere(const Point3 &center, float radius, const Vector3 &color, int samples = 16);
+
+    // Abschwächung bei quadriertem Abstand dist2
+    float attenuation(float dist2) const { return range > 0.0f ? 1.0f / (1.0f + dist2 / (range * range)) : 1.0f; }
+
+    // Anzahl tatsächlich verwendeter Schichten (1 für Punktlichter)
+    int sample_count() const;
+
+    // Lichtpunkt in Schicht index, innerhalb der Schicht zufällig verschoben.
+    // Bei Kugeln wird die dem Punkt zugewandte Kreisscheibe abgetastet.
+    Point3 sample_point(const Point3 &from, int index, uint32_t &rng) const;
+
+    BoundingBox bounds() const;
 };
 
 // Prüft, ob ein Punkt im Schatten liegt
 bool is_in_shadow(const Point3 &point, const Light &light, const std::vector<Triangle> &scene);
+
+// Knoten der Lichthierarchie: Box über die Lichter und Summe der Leistung
+struct LightNode
+{
+    BoundingBox bbox;
+    float power;         // Summe intensity * Helligkeit der Farbe
+    float max_range;     // Größte Reichweite im Teilbaum, 0 = ein Licht ohne Abfall
+    uint32_t left_first; // Innerer Knoten: linkes Kind, Blatt: erstes Licht
+    uint32_t count;      // 0 = innerer Knoten
+
+    bool is_leaf() const { return count > 0; }
+};
+
+// Ausgewähltes Licht; weight gleicht die Auswahlwahrscheinlichkeit aus
+struct LightSample
+{
+    const Light *light;
+    float weight;
+};
+
+// Lichtliste mit räumlicher Hierarchie. Beim Schattieren werden entweder alle
+// Lichter gewählt, deren Beitrag eine Schwelle überschreiten kann (ganze
+// Teilbäume fallen weg), oder eine feste Anzahl Lichter nach Wichtigkeit
+// gezogen. Der Aufwand pro Treffer wächst so nur logarithmisch mit der Anzahl.
+class LightTree
+{
+private:
+    std::vector<Light> lights;
+    std::vector<LightNode> nodes;
+    int sample_count = 0;
+    float min_contribution = 0.001f;
+
+    void build_recursive(uint32_t node_index, uint32_t first, uint32_t count);
+    float importance(const LightNode &node, const Point3 &point) const;
+
+public:
+    LightTree() = default;
+    // Ein einzelnes Licht, damit bestehender Code weiter ein Light übergeben kann
+    LightTree(const Light &light) { build({light}); }
+    explicit LightTree(const std::vector<Light> &lights) { build(lights); }
+
+    void build(const std::vector<Light> &lights);
+    size_t size() const { return lights.size(); }
+    const std::vector<Light> &get_lights() const { return lights; }
+
+    // 0 = exakt: alle Lichter mit möglichem Beitrag >= min_contribution
+    // n > 0 = stochastisch: n Lichter nach Wichtigkeit ziehen
+    void set_sample_count(int count) { sample_count = count; }
+    void set_min_contribution(float contribution) { min_contribution = contribution; }
+
+    // Wählt die Lichter für einen Trefferpunkt, out wird überschrieben
+    void select(const Point3 &point, uint32_t &rng, std::vector<LightSample> &out) const;
+
+    void print_stats() const;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include "geometry.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Oberflächeneigenschaften für das Phong-Shading. Die Standardwerte entsprechen
+// der früher fest eingebauten Beleuchtung.
+struct Material
+{
+    std::string name;           // Aus usemtl, leer für Farben aus "# color"
+    Vector3 color;              // Grundfarbe 0..255
+    float ambient = 0.2f;       // Umgebungslicht, auch im Schatten
+    float light_ambient = 0.1f; // Zusätzliches Umgebungslicht pro sichtbarem Licht
+    float diffuse = 0.8f;
+    float specular = 0.5f;
+    float shininess = 32.0f;    // Phong-Exponent
+    float reflectivity = 0.3f;  // 0 = keine Reflexionsstrahlen
+
+    Material() = default;
+    Material(const Vector3 &color) : color(color) {}
+};
+
+// Tabelle aller Materialien einer Szene. Dreiecke speichern nur einen 16-Bit-Index,
+// Eintrag 0 ist das weiße Standardmaterial. Die Tabelle wird beim Laden gefüllt
+// und während des Renderns nur gelesen.
+class MaterialTable
+{
+private:
+    std::vector<Material> materials;
+
+public:
+    MaterialTable() { clear(); }
+
+    // Entfernt alle Materialien bis auf das Standardmaterial
+    void clear();
+
+    // Fügt ein Material hinzu, wirft bei mehr als 65536 Einträgen
+    uint16_t add(const Material &material);
+
+    // Material mit dieser Farbe und Standardwerten, bei Bedarf neu angelegt
+    uint16_t for_color(const Vector3 &color);
+
+    // Index des Materials mit diesem Namen, -1 wenn es keines gibt
+    int find(const std::string &name) const;
+
+    Material &operator[](uint16_t index) { return materials[index]; }
+    const Material &operator[](uint16_t index) const { return materials[index]; }
+    size_t size() const { return materials.size(); }
+};
+
+// Gemeinsame Tabelle, auf die die Indizes der Dreiecke verweisen
+MaterialTable &material_table();
+
+inline const Material &get_material(const Triangle &tri)
+{
+    return material_table()[tri.material];
+}
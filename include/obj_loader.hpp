@@ -6,6 +6,53 @@
 #include <iostream>
 #include <cmath>
 #include "geometry.hpp"
+#include "material.hpp"
+
+// Liest eine .mtl-Datei in die MaterialTable. Ausgewertet werden Kd, Ks, Ns und
+// die Erweiterung "refl" für den Reflexionsanteil (Standard 0.3).
+inline void load_mtl(const std::string &filename)
+{
+    std::ifstream in(filename);
+    if (!in)
+    {
+        std::cout << "Warnung: MTL-Datei nicht gefunden: " << filename << "\n";
+        return;
+    }
+
+    MaterialTable &table = material_table();
+    int current = -1;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream iss(line);
+        std::string prefix;
+        if (!(iss >> prefix) || prefix[0] == '#')
+            continue;
+
+        if (prefix == "newmtl")
+        {
+            Material material;
+            iss >> material.name;
+            current = table.find(material.name);
+            if (current < 0)
+                current = table.add(material);
+            continue;
+        }
+        if (current < 0)
+            continue;
+
+        Material &material = table[static_cast<uint16_t>(current)];
+        float r, g, b;
+        if (prefix == "Kd" && iss >> r >> g >> b)
+            material.color = Vector3(r, g, b) * 255.0f;
+        else if (prefix == "Ks" && iss >> r >> g >> b)
+            material.specular = (r + g + b) / 3.0f;
+        else if (prefix == "Ns" && iss >> r)
+            material.shininess = r;
+        else if (prefix == "refl" && iss >> r)
+            material.reflectivity = r;
+    }
+}
 
 inline std::vector<Triangle> load_obj(const std::string &filename, const Vector3 &default_color = {255, 255, 255})
 {
@@ -17,7 +64,8 @@ inline std::vector<Triangle> load_obj(const std::string &filename, const Vector3
         throw std::runtime_error("Could not open .obj file: " + filename);
 
     std::string line;
-    Vector3 current_color = default_color;
+    MaterialTable &materials = material_table();
+    uint16_t current_material = materials.for_color(default_color);
     int line_number = 0;
 
     try
@@ -37,7 +85,7 @@ inline std::vector<Triangle> load_obj(const std::string &filename, const Vector3
                     int r, g, b;
                     if (iss >> hash >> tag >> r >> g >> b)
                     {
-                        current_color = Vector3((float)r, (float)g, (float)b);
+                        current_material = materials.for_color(Vector3((float)r, (float)g, (float)b));
                     }
                 }
                 continue;
@@ -95,7 +143,7 @@ inline std::vector<Triangle> load_obj(const std::string &filename, const Vector3
                             i3 >= 1 && i3 <= (int)vertices.size())
                         {
 
-                            triangles.emplace_back(vertices[i1 - 1], vertices[i2 - 1], vertices[i3 - 1], current_color);
+                            triangles.emplace_back(vertices[i1 - 1], vertices[i2 - 1], vertices[i3 - 1], current_material);
                         }
                         else
                         {
@@ -112,7 +160,33 @@ inline std::vector<Triangle> load_obj(const std::string &filename, const Vector3
                     std::cout << "Warnung: Fehlerhafte Face-Zeile " << line_number << ": " << line << "\n";
                 }
             }
-            // Andere Zeilen (mtllib, usemtl, o, g, s, vn, vt) ignorieren
+            else if (prefix == "mtllib")
+            {
+                // Pfad relativ zur OBJ-Datei
+                std::string mtl_name;
+                if (iss >> mtl_name)
+                {
+                    size_t slash = filename.find_last_of("/\\");
+                    load_mtl(slash == std::string::npos ? mtl_name : filename.substr(0, slash + 1) + mtl_name);
+                }
+            }
+            else if (prefix == "usemtl")
+            {
+                // Unbekannte Materialien bekommen die aktuelle Farbe und Standardwerte
+                std::string name;
+                if (iss >> name)
+                {
+                    int index = materials.find(name);
+                    if (index < 0)
+                    {
+                        Material material(materials[current_material].color);
+                        material.name = name;
+                        index = materials.add(material);
+                    }
+                    current_material = static_cast<uint16_t>(index);
+                }
+            }
+            // Andere Zeilen (o, g, s, vn, vt) ignorieren
         }
     }
     catch (const std::exception &e)
@@ -120,6 +194,7 @@ inline std::vector<Triangle> load_obj(const std::string &filename, const Vector3
         throw std::runtime_error("Fehler beim Laden der OBJ-Datei in Zeile " + std::to_string(line_number) + ": " + e.what());
     }
 
-    std::cout << "OBJ geladen: " << vertices.size() << " Vertices, " << triangles.size() << " Dreiecke\n";
+    std::cout << "OBJ geladen: " << vertices.size() << " Vertices, " << triangles.size() << " Dreiecke, "
+              << materials.size() << " Materialien\n";
     return triangles;
 }
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Reihenfolge, in der ein Renderer die Pixel besucht. Bei Morton und Hilbert
+// werden Kacheln entlang der Kurve abgearbeitet und die Pixel jeder Kachel in
+// Morton-Reihenfolge. Aufeinanderfolgende Strahlen liegen so im Bild nah
+// beieinander und treffen meist dieselben Knoten und Dreiecke, solange diese
+// noch im Cache liegen; zeilenweise springt der Strahl am Zeilenende zurück.
+enum class PixelOrder
+{
+    RowMajor,
+    Morton,
+    Hilbert
+};
+
+namespace pixel_order
+{
+// Jedes zweite Bit von v in die unteren 16 Bits zusammenschieben
+inline uint32_t compact_bits(uint32_t v)
+{
+    v &= 0x55555555u;
+    v = (v | (v >> 1)) & 0x33333333u;
+    v = (v | (v >> 2)) & 0x0f0f0f0fu;
+    v = (v | (v >> 4)) & 0x00ff00ffu;
+    v = (v | (v >> 8)) & 0x0000ffffu;
+    return v;
+}
+
+inline void morton_to_xy(uint32_t d, uint32_t &x, uint32_t &y)
+{
+    x = compact_bits(d);
+    y = compact_bits(d >> 1);
+}
+
+// Position d auf der Hilbert-Kurve in einem n x n Raster (n Zweierpotenz)
+inline void hilbert_to_xy(uint32_t n, uint32_t d, uint32_t &x, uint32_t &y)
+{
+    x = y = 0;
+    for (uint32_t s = 1; s < n; s *= 2)
+    {
+        uint32_t rx = 1 & (d / 2);
+        uint32_t ry = 1 & (d ^ rx);
+        if (ry == 0)
+        {
+            // Quadrant spiegeln bzw. drehen
+            if (rx == 1)
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+        x += s * rx;
+        y += s * ry;
+        d /= 4;
+    }
+}
+
+inline uint32_t next_power_of_two(uint32_t v)
+{
+    uint32_t p = 1;
+    while (p < v)
+        p *= 2;
+    return p;
+}
+}
+
+// Pixelindizes y * width + x in Besuchsreihenfolge, jedes Pixel genau einmal.
+// tile_size wird auf eine Zweierpotenz aufgerundet; Randkacheln und Kurvenpunkte
+// außerhalb des Bildes werden übersprungen.
+inline std::vector<uint32_t> make_pixel_order(int width, int height, PixelOrder order, int tile_size = 16)
+{
+    std::vector<uint32_t> pixels;
+    pixels.reserve(static_cast<size_t>(width) * height);
+
+    if (order == PixelOrder::RowMajor)
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(width) * height; ++i)
+            pixels.push_back(i);
+        return pixels;
+    }
+
+    const uint32_t tile = pixel_order::next_power_of_two(static_cast<uint32_t>(std::max(1, tile_size)));
+    const uint32_t tiles_x = (width + tile - 1) / tile;
+    const uint32_t tiles_y = (height + tile - 1) / tile;
+    const uint32_t grid = pixel_order::next_power_of_two(std::max(tiles_x, tiles_y));
+
+    for (uint32_t d = 0; d < grid * grid; ++d)
+    {
+        uint32_t tx, ty;
+        if (order == PixelOrder::Hilbert)
+            pixel_order::hilbert_to_xy(grid, d, tx, ty);
+        else
+            pixel_order::morton_to_xy(d, tx, ty);
+        if (tx >= tiles_x || ty >= tiles_y)
+            continue;
+
+        for (uint32_t k = 0; k < tile * tile; ++k)
+        {
+            uint32_t px, py;
+            pixel_order::morton_to_xy(k, px, py);
+            uint32_t x = tx * tile + px, y = ty * tile + py;
+            if (x < static_cast<uint32_t>(width) && y < static_cast<uint32_t>(height))
+                pixels.push_back(y * width + x);
+        }
+    }
+    return pixels;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "thread_pool.hpp"
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <cstdint>
+
+struct PngOptions
+{
+    int level = 6;           // 0 = unkomprimiert, 1 = schnell ... 9 = klein
+    int threads = 0;         // Kompressions-Threads, 0 = einer pro Hardware-Thread
+    int rows_per_strip = 16; // Zeilen pro unabhängig komprimiertem Streifen
+    ThreadPool *pool = nullptr; // Vorhandener Pool statt eigener Threads, threads wird dann ignoriert
+};
+
+// Schreibt ein RGB-PNG Zeile für Zeile (oberste zuerst), ohne das ganze Bild
+// im Speicher zu halten. Je rows_per_strip Zeilen bilden einen Streifen, den
+// ein Pool-Thread filtert und komprimiert (Deflate mit festen Huffman-Codes,
+// wie stb_image_write). Jeder Streifen endet byte-ausgerichtet mit einem leeren
+// Stored-Block, die Streifen lassen sich so in Reihenfolge zu einem zlib-Strom
+// aneinanderhängen. Der Speicherbedarf hängt nur von Breite, Streifenhöhe und
+// Threadanzahl ab. Wartet der schreibende Thread auf einen Streifen, den noch
+// kein Pool-Thread begonnen hat, komprimiert er ihn selbst; so darf der Writer
+// auch auf einem Thread des übergebenen Pools laufen.
+class PngStreamWriter
+{
+private:
+    struct Strip;
+
+    std::ofstream file;
+    std::string filename;
+    int width, height;
+    PngOptions options;
+    int rows_written = 0;
+    bool finished = false;
+
+    std::vector<unsigned char> previous_row; // Letzte Zeile des vorigen Streifens für die Filter
+    std::shared_ptr<Strip> current;          // Streifen, der gerade gefüllt wird
+    std::deque<std::pair<std::shared_ptr<Strip>, std::future<void>>> in_flight;
+    std::vector<unsigned char> chunk_prefix; // zlib-Kopf vor dem ersten Streifen
+    uint32_t adler = 1;
+    std::unique_ptr<ThreadPool> own_pool; // Nur ohne options.pool
+    ThreadPool *pool;
+
+    void submit_strip();
+    void write_front_strip();
+    void write_chunk(const char type[4], const unsigned char *data, size_t size);
+
+public:
+    PngStreamWriter(const std::string &filename, int width, int height, const PngOptions &options = PngOptions());
+    ~PngStreamWriter();
+
+    PngStreamWriter(const PngStreamWriter &) = delete;
+    PngStreamWriter &operator=(const PngStreamWriter &) = delete;
+
+    // Nächste Zeile von oben mit width RGB-Pixeln; wartet, wenn zu viele
+    // Streifen gleichzeitig in Arbeit sind
+    void write_row(const unsigned char *rgb);
+
+    // Schreibt die restlichen Streifen und schließt die Datei; wirft, wenn
+    // Zeilen fehlen oder das Schreiben fehlgeschlagen ist
+    void finish();
+};
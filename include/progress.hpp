@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Fortschritt und Statistik für Renderschleifen. Die Arbeiter zählen nur mit
+// relaxed-Atomics mit (erledigte Einheiten wie Zeilen, Pixel oder Kacheln und
+// Strahlen), am besten gesammelt pro Zeile oder Kachel. Ein eigener Thread
+// liest die Zähler in festem Abstand und gibt Prozent, Strahlen pro Sekunde
+// und die geschätzte Restzeit aus. Im Ruhemodus läuft kein Thread und es
+// erscheint keine Ausgabe.
+class ProgressReporter
+{
+private:
+    std::string label;
+    uint64_t total;
+    std::chrono::milliseconds interval;
+    std::chrono::steady_clock::time_point start;
+
+    // Eigene Cache-Zeilen, damit die Arbeiter nicht mit dem Rest des Objekts konkurrieren
+    alignas(64) std::atomic<uint64_t> done{0};
+    alignas(64) std::atomic<uint64_t> rays{0};
+
+    std::thread reporter;
+    std::mutex mutex; // Schützt stopping und die Konsolenausgabe
+    std::condition_variable wake;
+    bool stopping = false;
+    bool finished = false;
+    bool line_open = false; // Fortschrittszeile steht ohne Zeilenumbruch in der Konsole
+    size_t last_length = 0;
+
+    void report_loop();
+    void print_line(bool final);
+
+public:
+    // total_units: Anzahl der Einheiten bis 100 %
+    ProgressReporter(const std::string &label, uint64_t total_units, double interval_seconds = 0.5);
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter &) = delete;
+    ProgressReporter &operator=(const ProgressReporter &) = delete;
+
+    // Aus beliebigen Threads; ray_count = dabei verfolgte Kamerastrahlen
+    void advance(uint64_t units, uint64_t ray_count = 0)
+    {
+        done.fetch_add(units, std::memory_order_relaxed);
+        if (ray_count)
+            rays.fetch_add(ray_count, std::memory_order_relaxed);
+    }
+
+    // Meldung ausgeben, ohne die Fortschrittszeile zu zerreißen
+    void log(const std::string &line);
+
+    // Beendet den Reporter-Thread und schreibt die letzte Zeile; mehrfach aufrufbar
+    void finish();
+
+    double elapsed() const;
+    uint64_t rays_cast() const { return rays.load(std::memory_order_relaxed); }
+
+    // Ruhemodus für Batch-Läufe, gilt für alle Reporter
+    static void set_quiet(bool quiet);
+    static bool quiet();
+};
@@ -2,22 +2,100 @@
 #include "geometry.hpp"
 #include "camera.hpp"
 #include "light.hpp"
-#include "kdtree.hpp"
+#include "material.hpp"
+#include "acceleration.hpp"
+#include <cstdint>
+
+// Abbruch von Reflexionspfaden. Jeder Strahl trägt sein Pfadgewicht, also den
+// Anteil, mit dem sein Ergebnis in die Pixelfarbe eingeht.
+struct PathSettings
+{
+    int max_depth = 3;             // Tiefe 0..max_depth wird schattiert, danach Hintergrund
+    float min_weight = 0.5f / 255; // Leichtere Reflexionen ändern kein Pixel um mehr als eine halbe 8-Bit-Stufe
+    bool russian_roulette = false; // Unter min_weight zufällig abbrechen statt abschneiden
+};
+
+// Startwert des Zufallsgenerators für einen Pfad (nie 0)
+inline uint32_t path_seed(uint32_t pixel, uint32_t sample = 0)
+{
+    uint32_t h = pixel * 747796405u + sample * 2891336453u + 1u;
+    h = ((h >> ((h >> 28u) + 4u)) ^ h) * 277803737u;
+    h = (h >> 22u) ^ h;
+    return h ? h : 1u;
+}
+
+// Gleichverteilte Zahl in [0, 1), xorshift32
+inline float random_float(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Wahrscheinlichkeit, mit der eine Reflexion mit Gewicht reflected_weight verfolgt
+// wird. 1 = immer, 0 = Abbruch. Beim Russischen Roulette muss der Beitrag
+// überlebender Pfade durch den Rückgabewert geteilt werden.
+float path_survival(const PathSettings &settings, int next_depth, float reflected_weight, uint32_t &rng);
+
+// Ersatzwert für eine nicht verfolgte Reflexion: Hintergrund beim festen Abbruch,
+// schwarz beim Russischen Roulette (der Ausgleich steckt in den Überlebenden)
+Vector3 terminated_reflection(const PathSettings &settings, int next_depth);
 
 // Berechnet die Normale eines Dreiecks
 Vector3 compute_normal(const Triangle &tri);
 
+// Direkter Beitrag eines Lichts ohne Schattentest, gewichtet mit intensity und
+// Abfall. Enthält das Drittel der Umgebungsbeleuchtung, das ein Schatten wegnimmt.
+Vector3 direct_lighting(const Triangle &tri, const Point3 &hitpoint, const Vector3 &normal,
+                        const Camera &cam, const Light &light);
+
 // Phong-Shading für realistische Beleuchtung
 Vector3 phong_shading(const Triangle &tri, const Point3 &hitpoint, const Vector3 &normal,
                       const Camera &cam, const Light &light);
 
-// Schatten-Test mit KD-Tree
-bool is_in_shadow_kdtree(const Point3 &point, const Light &light, const KDTree &kdtree);
+// Beleuchtung durch die vom LightTree gewählten Lichter samt Schattentest
+Vector3 shade_lights(const Triangle &tri, const Point3 &hitpoint, const Vector3 &normal,
+                     const Camera &cam, const LightTree &lights, const Accelerator &accel, uint32_t &rng);
+
+// Schatten-Test mit Beschleunigungsstruktur (KD-Tree, BVH, ...)
+bool is_in_shadow_kdtree(const Point3 &point, const Light &light, const Accelerator &accel);
+
+// Verdecker-Cache: die letzten verdeckenden Dreiecke eines Threads. Benachbarte
+// Trefferpunkte werden meist vom selben Dreieck verdeckt, ein Test gegen wenige
+// Dreiecke spart dann die ganze Traversierung. Es gilt dasselbe Kriterium wie
+// in der Traversierung, ein Cache-Treffer ist also exakt.
+struct OccluderCache
+{
+    static const int size = 4;
+    const Accelerator *accel = nullptr;
+    const Triangle *entries[size] = {}; // Zuletzt benutzter zuerst
+
+    void reset(const Accelerator *owner);
+    bool test(const Ray &ray, float t_max);
+    void insert(const Triangle *tri);
+};
+
+// Cache des aufrufenden Threads, beim Wechsel der Struktur geleert
+OccluderCache &thread_occluder_cache(const Accelerator &accel);
+
+// Vor jedem Bild aufrufen: der Cache hält Zeiger in die Szene des letzten Bildes
+void clear_occluder_cache();
+
+// Schattentest: erst der Cache, dann die Traversierung
+bool occluded_cached(const Accelerator &accel, const Ray &ray, float t_max);
+
+// Hauptfunktion für Raytracing mit Beschleunigungsstruktur (KD-Tree, BVH, ...)
+Vector3 trace_kdtree(const Ray &ray, const Accelerator &accel, const Camera &cam,
+                     const LightTree &lights, const PathSettings &settings, uint32_t &rng,
+                     float weight = 1.0f, int depth = 0);
 
-// Hauptfunktion für Raytracing mit KD-Tree
-Vector3 trace_kdtree(const Ray &ray, const KDTree &kdtree, const Camera &cam,
-                     const Light &light, int depth = 0);
+// Schattierung eines bekannten Treffers samt Reflexion, z. B. aus dem G-Buffer
+Vector3 shade_hit(const Ray &ray, const Hit &hit, const Accelerator &accel, const Camera &cam,
+                  const LightTree &lights, const PathSettings &settings, uint32_t &rng,
+                  float weight = 1.0f, int depth = 0);
 
 // Hauptfunktion für Raytracing (ohne KD-Tree - für Vergleich)
 Vector3 trace(const Ray &ray, const std::vector<Triangle> &scene, const Camera &cam,
-              const Light &light, int depth = 0);
+              const LightTree &lights, const PathSettings &settings, uint32_t &rng,
+              float weight = 1.0f, int depth = 0);
@@ -3,24 +3,118 @@
 #include "image.hpp"
 #include "geometry.hpp"
 #include "light.hpp"
-#include "kdtree.hpp"
+#include "acceleration.hpp"
+#include "raytracer.hpp"
+#include "gbuffer.hpp"
+#include "pixel_order.hpp"
+#include <vector>
+#include <string>
+
+// Adaptive Kantenglättung: nach einem Strahl pro Pixel bekommen nur Pixel, deren
+// Dreieck oder Farbe von einem Nachbarn abweicht, zusätzliche Samples
+struct AntiAliasSettings
+{
+    int samples = 0;                // Zusätzliche Samples pro Kantenpixel, 0 = aus. Abgerundet auf ein
+                                    // volles Raster nx * ny mit nx = floor(sqrt(samples)), z. B. 10 -> 9
+    float color_threshold = 16.0f;  // Größte Kanalabweichung zum Nachbarn, ab der geglättet wird
+    bool compare_triangles = true;  // Auch Wechsel des getroffenen Dreiecks als Kante werten
+};
+
+// Fortschreitendes Rendern: Durchgang für Durchgang ein weiteres, zufällig im
+// Pixel verschobenes Sample, bis Zeitbudget, Konvergenz oder max_passes erreicht ist
+struct ProgressiveSettings
+{
+    double time_budget = 0.0;      // Sekunden, 0 = unbegrenzt
+    int max_passes = 64;
+    float convergence = 0.25f;     // Mittlere Änderung pro Durchgang (0..255), 0 = aus
+    int snapshot_interval = 0;     // Zwischenbild alle n Durchgänge, 0 = keines
+    std::string snapshot_path = "progressive.png"; // Format nach Endung, .pfm ungerundet in float
+};
+
+// Pixelrechteck im Bild (y = 0 ist wie bei set_pixel die unterste Zeile)
+struct PixelRect
+{
+    int x, y;
+    int width, height;
+};
 
 class Renderer
 {
 private:
     int width, height;
+    PathSettings path_settings;
+    AntiAliasSettings anti_alias;
+    bool use_gbuffer = false;
+    GBuffer gbuffer;
+
+    // Besuchsreihenfolge der Pixel, wird bei Bedarf aufgebaut
+    PixelOrder order = PixelOrder::RowMajor;
+    int order_tile = 16;
+    std::vector<uint32_t> visit_order;
+
+    // Besuchte KD-Tree-Knoten pro Pixel im ersten Durchgang von render_kdtree
+    std::vector<uint32_t> pixel_nodes;
+
+    // Ergebnis des ersten Durchgangs für die Kantensuche
+    std::vector<Vector3> first_colors;
+    std::vector<const Triangle *> first_triangles;
+
+    Vector3 trace_pixel(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                        int x, int y, bool reuse_gbuffer, const Triangle *&hit_triangle);
+    // Summe von samples geschichteten Samples im Pixel, count = tatsächliche Anzahl
+    Vector3 stratified_sum(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                           int x, int y, int samples, int &count);
+    // Mittel aus Pixelmitte und geschichteten Samples, count = zusätzlich verfolgte Strahlen
+    Vector3 supersample_pixel(const Accelerator &accel, const Camera &cam, const LightTree &lights, int x, int y,
+                              int &count);
+    bool is_edge(int x, int y) const;
+    const std::vector<uint32_t> &pixels_in_order();
 
 public:
     Renderer(int w, int h) : width(w), height(h) {}
 
-    // Rendert die Szene mit KD-Tree und zeigt Fortschritt an
-    void render_kdtree(const KDTree &kdtree, const Camera &cam,
-                       const Light &light, Image &img);
+    // Abbruchkriterien für Reflexionen (Tiefe, Mindestbeitrag, Russisches Roulette)
+    void set_path_settings(const PathSettings &settings) { path_settings = settings; }
+
+    // Adaptive Kantenglättung für render_kdtree
+    void set_anti_alias(const AntiAliasSettings &settings) { anti_alias = settings; }
+
+    // Erste Treffer pro Pixel behalten: weitere Bilder mit derselben Struktur und
+    // Kamera verfolgen keine Primärstrahlen mehr (nur render_kdtree)
+    void set_use_gbuffer(bool enabled) { use_gbuffer = enabled; }
+    // Nach Änderungen an der Geometrie aufrufen
+    void invalidate_gbuffer() { gbuffer.invalidate(); }
+
+    // Pixelreihenfolge für render_kdtree und render_progressive: Kacheln
+    // (tile_size x tile_size) entlang einer Morton- oder Hilbert-Kurve. Das Bild
+    // bleibt gleich, nur die Cache-Nutzung ändert sich.
+    void set_pixel_order(PixelOrder pixel_order, int tile_size = 16);
+
+    // Besuchte Knoten pro Pixel (y * width + x) aus dem letzten render_kdtree,
+    // z. B. als Wärmebild; gezählt wird nur von Strukturen mit Zählern (KD-Tree)
+    const std::vector<uint32_t> &traversal_nodes() const { return pixel_nodes; }
+
+    // Rendert die Szene mit Beschleunigungsstruktur (KD-Tree, BVH, ...) und zeigt Fortschritt an
+    void render_kdtree(const Accelerator &accel, const Camera &cam,
+                       const LightTree &lights, Image &img);
+
+    // Fortschreitendes Rendern in einen float-Puffer, liefert die Anzahl der
+    // vollständigen Durchgänge. Das Bild enthält am Ende den Mittelwert.
+    int render_progressive(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                           Image &img, const ProgressiveSettings &settings);
+
+    // Rendert nur den Ausschnitt region des width x height großen Bildes. Hat img
+    // die Größe des Ausschnitts, wird zugeschnitten geschrieben, sonst an die
+    // Stelle im ganzen Bild. samples > 1 verteilt geschichtete Samples im Pixel.
+    void render_region(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                       Image &img, const PixelRect &region, int samples = 1);
+
+    // Wie render_kdtree, aber ohne Bild im Speicher: jede fertige Zeile geht
+    // (von oben nach unten) direkt an einen PngStreamWriter
+    void render_to_png(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                       const std::string &filename, const PngOptions &options = PngOptions());
 
     // Rendert die Szene ohne KD-Tree (für Vergleich)
     void render(const std::vector<Triangle> &scene, const Camera &cam,
-                const Light &light, Image &img);
-
-    // Zeigt eine Fortschrittsleiste an
-    void show_progress(int current, int total);
+                const LightTree &lights, Image &img);
 };
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+// Feste Anzahl Arbeiter-Threads mit gemeinsamer Aufgabenliste. Die Threads
+// leben so lange wie der Pool, mehrere Bilder einer Animation teilen sie sich.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::packaged_task<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void worker_loop();
+
+public:
+    // 0 = ein Thread pro Hardware-Thread
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Aufgabe einreihen, die Future meldet das Ende (und Ausnahmen)
+    std::future<void> submit(std::function<void()> task);
+
+    // body(i) für alle i in [0, count), dynamisch verteilt. Der aufrufende
+    // Thread arbeitet mit und kehrt erst zurück, wenn alles erledigt ist.
+    void parallel_for(size_t count, const std::function<void(size_t)> &body);
+};
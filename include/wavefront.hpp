@@ -0,0 +1,88 @@
+#pragma once
+#include "camera.hpp"
+#include "image.hpp"
+#include "geometry.hpp"
+#include "light.hpp"
+#include "acceleration.hpp"
+#include "raytracer.hpp"
+#include "gbuffer.hpp"
+#include <vector>
+#include <cstdint>
+
+// Warteschlange aktiver Pfade im SoA-Layout. Jeder Pfad kennt sein Pixel und
+// das Gewicht, mit dem sein Beitrag in die Pixelfarbe eingeht.
+struct PathQueue
+{
+    RayStream rays;
+    std::vector<uint32_t> pixel;
+    std::vector<float> weight;
+
+    size_t size() const { return pixel.size(); }
+    void clear();
+    void reserve(size_t n);
+    void push_back(const Ray &ray, uint32_t pixel_index, float path_weight);
+};
+
+// Aufsummierte Zeit pro Stufe in Sekunden
+struct WavefrontTimings
+{
+    double generate = 0.0;
+    double extend = 0.0;
+    double shadow = 0.0;
+    double shade = 0.0;
+};
+
+// Iterativer Renderer: statt trace_kdtree pro Pixel rekursiv aufzurufen, läuft
+// jede Stufe (Erzeugen, Schneiden, Schatten, Schattieren) über eine ganze
+// Warteschlange von Strahlen. Abgeschlossene Pfade und Reflexionen unter dem
+// Mindestbeitrag werden nach jeder Stufe entfernt, die Beschleunigungsstruktur
+// bekommt so große kohärente Bündel. Bei deterministischen Einstellungen
+// (exakte Lichtauswahl, Punktlichter, kein Russisches Roulette) entspricht das
+// Ergebnis render_kdtree. Sonst zieht jede Stufe ihre Zufallszahlen aus
+// path_seed(Pixel, Stufe) statt aus einem fortlaufenden Generator pro Pixel;
+// das Bild ist dann gleich verteilt, aber nicht pixelgleich.
+class WavefrontRenderer
+{
+private:
+    int width, height;
+    size_t queue_size;
+    PathSettings path_settings;
+    bool use_gbuffer = false;
+    GBuffer gbuffer;
+
+    PathQueue current, next;
+    HitStream hits;
+    RayStream shadow_rays;                    // Ein Strahl pro Treffer und gewähltem Licht
+    std::vector<uint32_t> shadow_path;        // Zugehöriger Pfad in current
+    std::vector<Vector3> shadow_contribution; // Beitrag, falls das Licht sichtbar ist
+    std::vector<char> shadow_occluded;        // Ergebnis der Schattenanfrage
+    std::vector<const Triangle *> shadow_occluders; // Verdecker für den Cache, bei Instanzen nullptr
+    std::vector<Vector3> direct;              // Summe der sichtbaren Lichter pro Pfad
+    std::vector<LightSample> selected_lights;
+    std::vector<Vector3> radiance; // Farbsumme pro Pixel des aktuellen Abschnitts
+    WavefrontTimings timings;
+
+    void generate(const Camera &cam, uint32_t first_pixel, uint32_t count);
+    void extend(const Accelerator &accel, uint32_t first_pixel, int depth, bool reuse_gbuffer);
+    void shadow(const Accelerator &accel, const Camera &cam, const LightTree &lights, int depth);
+    void flush_shadow_rays(const Accelerator &accel);
+    void shade(uint32_t first_pixel, int depth);
+
+public:
+    // queue_size: Anzahl Pixel, die gleichzeitig durch die Stufen laufen
+    WavefrontRenderer(int w, int h, size_t queue_size = 1 << 16);
+
+    // Abbruchkriterien für Reflexionen, wie beim Renderer
+    void set_path_settings(const PathSettings &settings) { path_settings = settings; }
+
+    // Erste Treffer pro Pixel behalten: weitere Bilder mit derselben Struktur und
+    // Kamera überspringen das Schneiden der Primärstrahlen
+    void set_use_gbuffer(bool enabled) { use_gbuffer = enabled; }
+    // Nach Änderungen an der Geometrie aufrufen
+    void invalidate_gbuffer() { gbuffer.invalidate(); }
+
+    void render(const Accelerator &accel, const Camera &cam, const LightTree &lights, Image &img);
+
+    const WavefrontTimings &get_timings() const { return timings; }
+    void print_timings() const;
+};
@@ -5,16 +5,41 @@
 #include "include/obj_loader.hpp"
 #include "include/light.hpp"
 #include "include/renderer.hpp"
+#include "include/wavefront.hpp"
 #include "include/kdtree.hpp"
+#include "include/bvh.hpp"
+#include "include/animation.hpp"
+#include "include/distributed.hpp"
+#include "include/progress.hpp"
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
 
-int main()
+int main(int argc, char **argv)
 {
     // Rendering-Einstellungen - Höhere Qualität
     const int width = 1920;
     const int height = 1920;
 
+    // "--quiet" an beliebiger Stelle schaltet die Fortschrittsanzeigen ab (Batch-Läufe)
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--quiet")
+        {
+            ProgressReporter::set_quiet(true);
+            std::copy(argv + i + 1, argv + argc + 1, argv + i);
+            --argc;
+            --i;
+        }
+    }
+
+    // Bei rohen Bildern auf der Standardausgabe dürfen Meldungen den Strom nicht stören
+    if (argc > 3 && std::string(argv[1]) == "--animation" && std::string(argv[3]) == "-")
+        std::cout.rdbuf(std::cerr.rdbuf());
+
     // Szene laden
     auto scene = load_obj("scenes/twisted_torus_no_numpy.obj", {240, 180, 255});
 
@@ -67,17 +92,75 @@ int main()
     std::chrono::duration<double> build_time = build_end - build_start;
     std::cout << "KD-Tree Aufbauzeit: " << build_time.count() << " Sekunden\n\n";
 
-    // Renderer erstellen und Szene mit KD-Tree rendern
-    Renderer renderer(width, height);
-    renderer.render_kdtree(kdtree, cam, light, img);
+    // Batch-Modus: "--animation N [muster]" rendert N Bilder einer Kreisfahrt um die
+    // Szene, Szene und KD-Tree werden dafür nur einmal geladen bzw. aufgebaut.
+    // Muster "-" schreibt rohe RGB-Bilder auf die Standardausgabe, z. B. für ffmpeg
+    if (argc > 2 && std::string(argv[1]) == "--animation")
+    {
+        int frame_count = std::max(1, std::atoi(argv[2]));
+        std::string pattern = argc > 3 ? argv[3] : "frame_%04d.png";
+        std::vector<Keyframe> keyframes;
+        Point3 center = {center_x, center_y, center_z};
+        Vector3 offset = cam_pos - center;
+        for (int k = 0; k <= 8; ++k)
+        {
+            // Kamera auf einer Kreisbahn um die Y-Achse, Blick und Licht drehen mit
+            Transform rotation = Transform::rotate_y(6.2831853f * k / 8);
+            Point3 eye = center + rotation.apply_vector(offset);
+            Light key_light = light;
+            key_light.position = center + rotation.apply_vector(light.position - center);
+            keyframes.push_back({Camera(eye, rotation.apply_vector(cam_dir), size * 0.4f, size * 0.4f, width, height), key_light});
+        }
+
+        AnimationRenderer animation(width, height);
+        animation.render(kdtree, keyframes, frame_count, pattern);
+        return 0;
+    }
+
+    // Worker-Modus: vom Koordinator gestartet, Kacheln kommen über die beiden Pipes
+    if (argc > 3 && std::string(argv[1]) == "--worker")
+    {
+        run_tile_worker(std::atoi(argv[2]), std::atoi(argv[3]), kdtree, cam, light);
+        return 0;
+    }
+
+    // Verteilt: "--distributed N" startet N Worker-Prozesse, die Szene und KD-Tree
+    // jeweils selbst laden bzw. aufbauen, und setzt ihre Kacheln zusammen
+    if (argc > 2 && std::string(argv[1]) == "--distributed")
+    {
+        TileCoordinator coordinator(width, height);
+        coordinator.render_spawned(img, std::max(1, std::atoi(argv[2])), {argv[0], "--worker"});
+        img.save_png("output_torus_view_from_right_hq.png");
+        std::cout << "Bild gespeichert als output_torus_view_from_right_hq.png ✅\n";
+        return 0;
+    }
+
+    // Szene mit KD-Tree rendern, Strahlen laufen stufenweise als Wellenfront
+    WavefrontRenderer wavefront(width, height);
+    wavefront.render(kdtree, cam, light, img);
 
     // Bild speichern
     img.save_png("output_torus_view_from_right_hq.png");
     std::cout << "Bild mit KD-Tree gespeichert als output_torus_view_from_right_hq.png ✅\n";
 
+    // Vergleich: 8-fach breite BVH über dieselben Dreiecke
+    std::cout << "\nVergleichsrendering mit BVH8...\n";
+    BVH8 bvh8;
+    build_start = std::chrono::high_resolution_clock::now();
+    bvh8.build(scene);
+    build_end = std::chrono::high_resolution_clock::now();
+    build_time = build_end - build_start;
+    std::cout << "BVH8 Aufbauzeit: " << build_time.count() << " Sekunden\n\n";
+
+    Image img_bvh8(width, height);
+    wavefront.render(bvh8, cam, light, img_bvh8);
+    img_bvh8.save_png("output_torus_view_from_right_hq_bvh8.png");
+    std::cout << "Bild mit BVH8 gespeichert als output_torus_view_from_right_hq_bvh8.png ✅\n";
+
     // Optional: Vergleichsrendering ohne KD-Tree
     std::cout << "\nVergleichsrendering ohne KD-Tree...\n";
     Image img_normal(width, height);
+    Renderer renderer(width, height);
     renderer.render(scene, cam, light, img_normal);
     img_normal.save_png("output_torus_view_from_right_hq_normal.png");
     std::cout << "Bild ohne KD-Tree gespeichert als output_torus_view_from_right_hq_normal.png ✅\n";
@@ -0,0 +1,139 @@
+#include "../include/acceleration.hpp"
+#include <algorithm>
+
+// BoundingBox Implementation
+void BoundingBox::expand(const Point3 &point)
+{
+    min.x = std::min(min.x, point.x);
+    min.y = std::min(min.y, point.y);
+    min.z = std::min(min.z, point.z);
+    max.x = std::max(max.x, point.x);
+    max.y = std::max(max.y, point.y);
+    max.z = std::max(max.z, point.z);
+}
+
+void BoundingBox::expand(const BoundingBox &box)
+{
+    expand(box.min);
+    expand(box.max);
+}
+
+float BoundingBox::surface_area() const
+{
+    Vector3 d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+int BoundingBox::longest_axis() const
+{
+    Vector3 d = max - min;
+    if (d.x > d.y && d.x > d.z)
+        return 0;
+    if (d.y > d.z)
+        return 1;
+    return 2;
+}
+
+// RayStream / HitStream Implementation
+void RayStream::clear()
+{
+    ox.clear();
+    oy.clear();
+    oz.clear();
+    dx.clear();
+    dy.clear();
+    dz.clear();
+    t_max.clear();
+}
+
+void RayStream::reserve(size_t n)
+{
+    ox.reserve(n);
+    oy.reserve(n);
+    oz.reserve(n);
+    dx.reserve(n);
+    dy.reserve(n);
+    dz.reserve(n);
+    t_max.reserve(n);
+}
+
+void RayStream::push_back(const Ray &ray, float max_t)
+{
+    ox.push_back(ray.origin.x);
+    oy.push_back(ray.origin.y);
+    oz.push_back(ray.origin.z);
+    dx.push_back(ray.direction.x);
+    dy.push_back(ray.direction.y);
+    dz.push_back(ray.direction.z);
+    t_max.push_back(max_t);
+}
+
+void HitStream::resize(size_t n)
+{
+    t.assign(n, 1e30f);
+    triangle.assign(n, nullptr);
+    normal.resize(n);
+}
+
+// Accelerator Standardimplementierungen
+bool Accelerator::intersect_hit(const Ray &ray, Hit &hit) const
+{
+    if (!intersect(ray, hit.t, hit.triangle))
+        return false;
+
+    hit.normal = hit.triangle->normal();
+    return true;
+}
+
+bool Accelerator::occluded(const Ray &ray, float t_max) const
+{
+    const Triangle *occluder;
+    return find_occluder(ray, t_max, occluder);
+}
+
+bool Accelerator::find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const
+{
+    float t;
+    occluder = nullptr;
+    if (!intersect(ray, t, occluder) || t >= t_max)
+    {
+        occluder = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void Accelerator::intersect_stream(const RayStream &rays, HitStream &hits) const
+{
+    hits.resize(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        Hit hit;
+        if (intersect_hit(rays.ray(i), hit) && hit.t < rays.t_max[i])
+        {
+            hits.t[i] = hit.t;
+            hits.triangle[i] = hit.triangle;
+            hits.normal[i] = hit.normal;
+        }
+    }
+}
+
+void Accelerator::occluded_stream(const RayStream &rays, std::vector<char> &occluded_flags) const
+{
+    occluded_flags.assign(rays.size(), 0);
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        occluded_flags[i] = occluded(rays.ray(i), rays.t_max[i]);
+    }
+}
+
+void Accelerator::occluder_stream(const RayStream &rays, std::vector<char> &occluded,
+                                  std::vector<const Triangle *> &occluders) const
+{
+    occluded.assign(rays.size(), 0);
+    occluders.assign(rays.size(), nullptr);
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        occluded[i] = find_occluder(rays.ray(i), rays.t_max[i], occluders[i]);
+    }
+}
@@ -0,0 +1,193 @@
+#include "../include/animation.hpp"
+#include "../include/progress.hpp"
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+#include <cctype>
+
+namespace
+{
+Vector3 lerp(const Vector3 &a, const Vector3 &b, float t)
+{
+    return a + (b - a) * t;
+}
+
+float lerp(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+// Setzt die Bildnummer ins Muster. Erlaubt ist genau eine Umwandlung %d bzw. %i
+// mit Flags (-+ 0), Breite und Genauigkeit, %% steht für ein Prozentzeichen.
+// Das Muster geht nie als Ganzes an snprintf, fremde Umwandlungen wie %s
+// würden dort ein nicht vorhandenes Argument lesen.
+std::string frame_name(const std::string &pattern, int frame)
+{
+    if (pattern == "-")
+        return pattern;
+
+    const std::string flags = "-+ 0";
+    auto is_digit = [&](size_t i)
+    { return i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i])); };
+
+    std::string name;
+    int conversions = 0;
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] != '%')
+        {
+            name += pattern[i];
+            continue;
+        }
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%')
+        {
+            name += '%';
+            ++i;
+            continue;
+        }
+
+        size_t end = i + 1;
+        while (end < pattern.size() && flags.find(pattern[end]) != std::string::npos)
+            ++end;
+        while (is_digit(end))
+            ++end;
+        if (end < pattern.size() && pattern[end] == '.')
+        {
+            ++end;
+            while (is_digit(end))
+                ++end;
+        }
+        if (end >= pattern.size() || (pattern[end] != 'd' && pattern[end] != 'i'))
+            throw std::runtime_error("Ungültige Umwandlung im Dateimuster (erlaubt sind %d und %%): " + pattern);
+
+        // Nur die geprüfte Umwandlung formatieren, Länge vorher erfragen
+        std::string spec = pattern.substr(i, end + 1 - i);
+        int length = std::snprintf(nullptr, 0, spec.c_str(), frame);
+        if (length < 0)
+            throw std::runtime_error("Bildnummer passt nicht ins Dateimuster: " + pattern);
+        std::string number(static_cast<size_t>(length) + 1, '\0');
+        std::snprintf(&number[0], number.size(), spec.c_str(), frame);
+        number.resize(static_cast<size_t>(length));
+
+        name += number;
+        ++conversions;
+        i = end;
+    }
+
+    if (conversions != 1)
+        throw std::runtime_error("Dateimuster braucht genau eine Bildnummer wie %04d: " + pattern);
+    return name;
+}
+}
+
+Keyframe interpolate_keyframes(const std::vector<Keyframe> &keyframes, int frame, int frame_count)
+{
+    if (keyframes.empty())
+        throw std::runtime_error("Keine Schlüsselbilder angegeben");
+    if (keyframes.size() == 1 || frame_count <= 1)
+        return keyframes.front();
+
+    // Position auf der Schlüsselbild-Achse, der Rest ist der Anteil im Abschnitt
+    float position = static_cast<float>(frame) * (keyframes.size() - 1) / (frame_count - 1);
+    size_t segment = std::min(static_cast<size_t>(position), keyframes.size() - 2);
+    float t = position - segment;
+
+    const Keyframe &a = keyframes[segment];
+    const Keyframe &b = keyframes[segment + 1];
+    Camera cam(lerp(a.camera.eye, b.camera.eye, t), lerp(a.camera.view, b.camera.view, t),
+               lerp(a.camera.width, b.camera.width, t), lerp(a.camera.height, b.camera.height, t),
+               a.camera.width_px, a.camera.height_px);
+
+    Light light = t < 0.5f ? a.light : b.light;
+    light.position = lerp(a.light.position, b.light.position, t);
+    light.color = lerp(a.light.color, b.light.color, t);
+    light.intensity = lerp(a.light.intensity, b.light.intensity, t);
+    return {cam, light};
+}
+
+// AnimationRenderer Implementation
+AnimationRenderer::AnimationRenderer(int w, int h, size_t thread_count)
+    : width(w), height(h), pool(thread_count), frames{Image(w, h), Image(w, h)}
+{
+}
+
+void AnimationRenderer::render_frame(const Accelerator &accel, const Camera &cam, const LightTree &lights, Image &img,
+                                     ProgressReporter &progress)
+{
+    // Zeilen dynamisch auf die Threads verteilt, jedes Pixel wird nur von einem Thread geschrieben
+    pool.parallel_for(static_cast<size_t>(height), [&](size_t row)
+                      {
+        int y = static_cast<int>(row);
+        // Der Verdecker-Cache gehört dem Thread und kann noch auf ein altes Bild zeigen
+        clear_occluder_cache();
+        thread_local std::vector<float> dx, dy, dz;
+        dx.resize(width);
+        dy.resize(width);
+        dz.resize(width);
+        cam.row_directions(y, 0, width, dx.data(), dy.data(), dz.data());
+        for (int x = 0; x < width; ++x)
+        {
+            Ray ray = Ray::with_unit_direction(cam.eye, Vector3(dx[x], dy[x], dz[x]));
+            uint32_t rng = path_seed(y * width + x);
+            Vector3 color = trace_kdtree(ray, accel, cam, lights, path_settings, rng);
+            img.set_pixel(x, y, Color(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z)));
+        }
+        progress.advance(1, width); });
+}
+
+void AnimationRenderer::render(const Accelerator &accel, const std::vector<Keyframe> &keyframes, int frame_count,
+                               const std::string &output_pattern)
+{
+    std::cout << "Animation mit " << frame_count << " Bildern und " << pool.size() << " Threads ("
+              << accel.name() << ") gestartet...\n";
+    // Ungültige Muster vor dem ersten Bild ablehnen
+    frame_name(output_pattern, 0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ProgressReporter progress("Animation", static_cast<uint64_t>(frame_count) * height);
+
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        auto frame_start = std::chrono::high_resolution_clock::now();
+        Keyframe key = interpolate_keyframes(keyframes, frame, frame_count);
+        LightTree lights(key.light);
+
+        // Der Puffer wird frei, sobald das vorletzte Bild geschrieben ist
+        int buffer = frame % 2;
+        if (encoding[buffer].valid())
+            encoding[buffer].get();
+
+        render_frame(accel, key.camera, lights, frames[buffer], progress);
+
+        // Bei einem Strom auf die Standardausgabe muss das vorige Bild vollständig
+        // geschrieben sein, bevor das nächste beginnt; es lief ohnehin parallel
+        // zum gerade gerenderten Bild
+        std::string filename = frame_name(output_pattern, frame);
+        if (filename == "-" && encoding[1 - buffer].valid())
+            encoding[1 - buffer].get();
+        // PNG-Streifen laufen über denselben Pool, statt pro Bild eigene Threads zu starten
+        Image &img = frames[buffer];
+        PngOptions png;
+        png.pool = &pool;
+        encoding[buffer] = pool.submit([&img, filename, png]()
+                                       { img.save(filename, png); });
+
+        std::chrono::duration<double> frame_time = std::chrono::high_resolution_clock::now() - frame_start;
+        std::ostringstream line;
+        line << "Bild " << frame + 1 << "/" << frame_count << ": " << frame_time.count() << " s -> " << filename;
+        progress.log(line.str());
+    }
+
+    for (std::future<void> &pending : encoding)
+    {
+        if (pending.valid())
+            pending.get();
+    }
+    progress.finish();
+
+    std::chrono::duration<double> total = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "Animation fertig: " << total.count() << " Sekunden\n";
+}
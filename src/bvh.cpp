@@ -0,0 +1,649 @@
+#include "../include/bvh.hpp"
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+#include <cassert>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const int SAH_BINS = 16;
+    const float SAH_TRAVERSAL_COST = 1.0f;
+    const int STACK_SIZE = 256;
+
+    // Ein innerer Knoten der Tiefe d findet höchstens d wartende Geschwister auf
+    // dem Stack vor und legt zwei Kinder dazu. Ab dieser Tiefe wird nur noch in
+    // der Mitte geteilt; nach höchstens 32 Halbierungen ist jeder Ast ein Blatt,
+    // die binäre Traversierung kommt also mit STACK_SIZE Einträgen aus.
+    const int MEDIAN_SPLIT_DEPTH = STACK_SIZE - 2 - 32;
+
+    struct StackEntry
+    {
+        uint32_t node;
+        uint32_t count; // > 0: Blatt des BVH8 mit count Dreiecken ab node
+        float t_near;
+    };
+}
+
+// BVH Implementation
+BVH::BVH(int max_triangles_per_leaf, bool verbose)
+    : max_triangles_per_leaf(std::max(max_triangles_per_leaf, 1)), verbose(verbose)
+{
+}
+
+void BVH::build(const std::vector<Triangle> &input)
+{
+    if (verbose)
+        std::cout << "Building BVH with " << input.size() << " triangles...\n";
+
+    nodes.clear();
+    triangles.clear();
+    source_data = input.data();
+    source_size = input.size();
+    build_cost = 0.0f;
+    if (input.empty())
+        return;
+
+    std::vector<BuildPrimitive> prims;
+    prims.reserve(input.size());
+    for (const auto &tri : input)
+    {
+        BuildPrimitive prim;
+        prim.bbox.expand(tri.v0);
+        prim.bbox.expand(tri.v1);
+        prim.bbox.expand(tri.v2);
+        prim.centroid = (prim.bbox.min + prim.bbox.max) * 0.5f;
+        prim.triangle = &tri;
+        prims.push_back(prim);
+    }
+
+    nodes.reserve(2 * input.size());
+    nodes.emplace_back();
+    build_recursive(0, prims, 0, static_cast<uint32_t>(prims.size()), 0);
+
+    triangles.reserve(prims.size());
+    for (const auto &prim : prims)
+    {
+        triangles.push_back(prim.triangle);
+    }
+
+    build_cost = sah_cost();
+
+    if (verbose)
+    {
+        std::cout << "BVH built successfully!\n";
+        print_stats();
+    }
+}
+
+bool BVH::same_source(const std::vector<Triangle> &input) const
+{
+    return input.data() == source_data && input.size() == source_size;
+}
+
+void BVH::refit(const std::vector<Triangle> &input)
+{
+    // Die Zeiger in triangles zeigen nur in den Vektor vom Aufbau
+    if (!same_source(input))
+    {
+        build(input);
+        return;
+    }
+
+    // Kinder liegen immer hinter ihrem Elternknoten: rückwärts laufen genügt
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        BVHNode &node = nodes[i];
+        BoundingBox bbox;
+        if (node.is_leaf())
+        {
+            for (uint32_t k = node.left_first; k < node.left_first + node.count; ++k)
+            {
+                bbox.expand(triangles[k]->v0);
+                bbox.expand(triangles[k]->v1);
+                bbox.expand(triangles[k]->v2);
+            }
+        }
+        else
+        {
+            bbox = nodes[node.left_first].bbox;
+            bbox.expand(nodes[node.left_first + 1].bbox);
+        }
+        node.bbox = bbox;
+    }
+}
+
+bool BVH::update(const std::vector<Triangle> &input)
+{
+    // Topologie oder Speicherort geändert: Refit nicht möglich
+    if (!same_source(input))
+    {
+        build(input);
+        return true;
+    }
+
+    refit(input);
+
+    float ratio = quality();
+    if (ratio > rebuild_threshold)
+    {
+        if (verbose)
+            std::cout << "BVH-Qualität auf " << ratio << "x der Aufbaukosten gesunken, baue neu...\n";
+        build(input);
+        return true;
+    }
+    return false;
+}
+
+// SAH-Kosten des Baums relativ zur Wurzelfläche
+float BVH::sah_cost() const
+{
+    if (nodes.empty())
+        return 0.0f;
+
+    float root_area = std::max(nodes[0].bbox.surface_area(), 1e-20f);
+    float cost = 0.0f;
+    for (const auto &node : nodes)
+    {
+        float area = node.bbox.surface_area() / root_area;
+        cost += node.is_leaf() ? area * node.count : area * SAH_TRAVERSAL_COST;
+    }
+    return cost;
+}
+
+void BVH::build_recursive(uint32_t node_index, std::vector<BuildPrimitive> &prims, uint32_t first, uint32_t count, int depth)
+{
+    BoundingBox bbox, centroid_bounds;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        bbox.expand(prims[i].bbox);
+        centroid_bounds.expand(prims[i].centroid);
+    }
+    nodes[node_index].bbox = bbox;
+    nodes[node_index].left_first = first;
+    nodes[node_index].count = count;
+
+    if (count <= 1)
+        return;
+
+    // SAH über Bins der Schwerpunkte auf allen drei Achsen
+    int best_axis = -1;
+    int best_bin = 0;
+    float best_cost = 1e30f;
+
+    for (int axis = 0; axis < 3 && depth < MEDIAN_SPLIT_DEPTH; ++axis)
+    {
+        float lo = centroid_bounds.min[axis];
+        float extent = centroid_bounds.max[axis] - lo;
+        if (extent < 1e-12f)
+            continue;
+
+        BoundingBox bin_bbox[SAH_BINS];
+        int bin_count[SAH_BINS] = {0};
+        float scale = SAH_BINS / extent;
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            int bin = std::min(SAH_BINS - 1, static_cast<int>((prims[i].centroid[axis] - lo) * scale));
+            bin_count[bin]++;
+            bin_bbox[bin].expand(prims[i].bbox);
+        }
+
+        // Flächen von rechts nach links vorberechnen
+        float right_area[SAH_BINS];
+        int right_count[SAH_BINS];
+        BoundingBox acc;
+        int acc_count = 0;
+        for (int b = SAH_BINS - 1; b > 0; --b)
+        {
+            acc.expand(bin_bbox[b]);
+            acc_count += bin_count[b];
+            right_area[b] = acc_count ? acc.surface_area() : 0.0f;
+            right_count[b] = acc_count;
+        }
+
+        acc = BoundingBox();
+        acc_count = 0;
+        for (int b = 0; b < SAH_BINS - 1; ++b)
+        {
+            acc.expand(bin_bbox[b]);
+            acc_count += bin_count[b];
+            if (acc_count == 0 || right_count[b + 1] == 0)
+                continue;
+
+            float cost = acc.surface_area() * acc_count + right_area[b + 1] * right_count[b + 1];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = b;
+            }
+        }
+    }
+
+    float leaf_cost = static_cast<float>(count);
+    float split_cost = SAH_TRAVERSAL_COST + best_cost / std::max(bbox.surface_area(), 1e-20f);
+    if (count <= static_cast<uint32_t>(max_triangles_per_leaf) && (best_axis < 0 || split_cost >= leaf_cost))
+        return;
+
+    uint32_t mid;
+    if (best_axis >= 0)
+    {
+        float lo = centroid_bounds.min[best_axis];
+        float scale = SAH_BINS / (centroid_bounds.max[best_axis] - lo);
+        auto it = std::partition(prims.begin() + first, prims.begin() + first + count,
+                                 [&](const BuildPrimitive &prim)
+                                 {
+                                     int bin = std::min(SAH_BINS - 1, static_cast<int>((prim.centroid[best_axis] - lo) * scale));
+                                     return bin <= best_bin;
+                                 });
+        mid = static_cast<uint32_t>(it - prims.begin());
+    }
+    else
+    {
+        // Alle Schwerpunkte fallen zusammen oder der Baum ist zu tief: in der Mitte teilen
+        mid = first + count / 2;
+    }
+
+    if (mid == first || mid == first + count)
+        mid = first + count / 2;
+
+    uint32_t left = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[node_index].left_first = left;
+    nodes[node_index].count = 0;
+
+    build_recursive(left, prims, first, mid - first, depth + 1);
+    build_recursive(left + 1, prims, mid, first + count - mid, depth + 1);
+}
+
+bool BVH::intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const
+{
+    if (nodes.empty())
+        return false;
+
+    float min_t = 1e30f;
+    const Triangle *closest_triangle = nullptr;
+
+    StackEntry stack[STACK_SIZE];
+    int sp = 0;
+    float t_min, t_max;
+    if (nodes[0].bbox.intersect(ray, t_min, t_max))
+        stack[sp++] = {0, 0, t_min};
+
+    while (sp > 0)
+    {
+        StackEntry entry = stack[--sp];
+        if (entry.t_near > min_t)
+            continue;
+
+        const BVHNode &node = nodes[entry.node];
+        if (node.is_leaf())
+        {
+            for (uint32_t i = node.left_first; i < node.left_first + node.count; ++i)
+            {
+                float tri_t;
+                if (triangles[i]->intersect(ray, tri_t) && tri_t < min_t && tri_t > 0.001f)
+                {
+                    min_t = tri_t;
+                    closest_triangle = triangles[i];
+                }
+            }
+            continue;
+        }
+
+        // Nahes Kind zuletzt auf den Stack, damit es zuerst bearbeitet wird
+        assert(sp + 2 <= STACK_SIZE);
+        float t_left, t_right, t_exit;
+        bool hit_left = nodes[node.left_first].bbox.intersect(ray, t_left, t_exit) && t_left <= min_t;
+        bool hit_right = nodes[node.left_first + 1].bbox.intersect(ray, t_right, t_exit) && t_right <= min_t;
+        if (hit_left && hit_right)
+        {
+            if (t_left < t_right)
+            {
+                stack[sp++] = {node.left_first + 1, 0, t_right};
+                stack[sp++] = {node.left_first, 0, t_left};
+            }
+            else
+            {
+                stack[sp++] = {node.left_first, 0, t_left};
+                stack[sp++] = {node.left_first + 1, 0, t_right};
+            }
+        }
+        else if (hit_left)
+        {
+            stack[sp++] = {node.left_first, 0, t_left};
+        }
+        else if (hit_right)
+        {
+            stack[sp++] = {node.left_first + 1, 0, t_right};
+        }
+    }
+
+    if (!closest_triangle)
+        return false;
+
+    t = min_t;
+    hit_triangle = closest_triangle;
+    return true;
+}
+
+bool BVH::find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const
+{
+    occluder = nullptr;
+    if (nodes.empty())
+        return false;
+
+    uint32_t stack[STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const BVHNode &node = nodes[stack[--sp]];
+        float box_t_min, box_t_max;
+        if (!node.bbox.intersect(ray, box_t_min, box_t_max) || box_t_min > t_max)
+            continue;
+
+        if (node.is_leaf())
+        {
+            for (uint32_t i = node.left_first; i < node.left_first + node.count; ++i)
+            {
+                float t;
+                if (triangles[i]->intersect(ray, t) && t < t_max && t > 0.001f)
+                {
+                    occluder = triangles[i];
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        assert(sp + 2 <= STACK_SIZE);
+        stack[sp++] = node.left_first + 1;
+        stack[sp++] = node.left_first;
+    }
+    return false;
+}
+
+void BVH::print_stats() const
+{
+    int leaf_count = 0;
+    for (const auto &node : nodes)
+    {
+        if (node.is_leaf())
+            leaf_count++;
+    }
+
+    std::cout << "BVH Statistics:\n";
+    std::cout << "  Nodes: " << nodes.size() << " (" << nodes.size() * sizeof(BVHNode) / 1024 << " KB)\n";
+    std::cout << "  Leaf nodes: " << leaf_count << "\n";
+    std::cout << "  Average triangles per leaf: " << (float)triangles.size() / std::max(leaf_count, 1) << "\n";
+}
+
+// BVH8 Implementation
+void BVH8::build(const std::vector<Triangle> &input)
+{
+    if (verbose)
+        std::cout << "Building BVH8 with " << input.size() << " triangles...\n";
+
+    nodes.clear();
+    triangles.clear();
+    root_bbox = BoundingBox();
+
+    BVH binary(4, false);
+    binary.build(input);
+    if (binary.get_nodes().empty())
+        return;
+
+    triangles = binary.get_triangles();
+    root_bbox = binary.bounds();
+    nodes.reserve(binary.get_nodes().size() / 4 + 1);
+    collapse(binary.get_nodes(), 0);
+
+    if (verbose)
+    {
+        std::cout << "BVH8 built successfully!\n";
+        print_stats();
+    }
+}
+
+uint32_t BVH8::collapse(const std::vector<BVHNode> &binary, uint32_t binary_index)
+{
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    // Innere Kinder mit der größten Oberfläche öffnen, bis acht Slots belegt sind
+    std::vector<uint32_t> slots = {binary_index};
+    while (slots.size() < 8)
+    {
+        int best = -1;
+        float best_area = -1.0f;
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            const BVHNode &candidate = binary[slots[i]];
+            if (!candidate.is_leaf() && candidate.bbox.surface_area() > best_area)
+            {
+                best = static_cast<int>(i);
+                best_area = candidate.bbox.surface_area();
+            }
+        }
+        if (best < 0)
+            break;
+
+        uint32_t left = binary[slots[best]].left_first;
+        slots[best] = left;
+        slots.push_back(left + 1);
+    }
+
+    BVH8Node node;
+    for (int k = 0; k < 8; ++k)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            node.bounds[0][axis][k] = 1e30f;
+            node.bounds[1][axis][k] = -1e30f;
+        }
+        node.child[k] = 0;
+        node.count[k] = 0;
+    }
+    node.child_count = static_cast<uint32_t>(slots.size());
+
+    for (size_t k = 0; k < slots.size(); ++k)
+    {
+        const BVHNode &child = binary[slots[k]];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            node.bounds[0][axis][k] = child.bbox.min[axis];
+            node.bounds[1][axis][k] = child.bbox.max[axis];
+        }
+
+        if (child.is_leaf())
+        {
+            node.child[k] = child.left_first;
+            node.count[k] = child.count;
+        }
+        else
+        {
+            node.child[k] = collapse(binary, slots[k]);
+        }
+    }
+
+    nodes[index] = node;
+    return index;
+}
+
+// Testet alle acht Kindboxen; liefert eine Bitmaske der getroffenen Kinder
+int BVH8::intersect_children(const BVH8Node &node, const Ray &ray, float max_t, float *t_near) const
+{
+    // Das Vorzeichen wählt pro Achse die nahe und ferne Ebene,
+    // leere Slots mit invertierter Box werden dadurch immer verworfen
+    const int sx = ray.sign[0], sy = ray.sign[1], sz = ray.sign[2];
+
+#if defined(__AVX__)
+    const __m256 ox = _mm256_set1_ps(ray.origin.x);
+    const __m256 oy = _mm256_set1_ps(ray.origin.y);
+    const __m256 oz = _mm256_set1_ps(ray.origin.z);
+    const __m256 ix = _mm256_set1_ps(ray.inv_direction.x);
+    const __m256 iy = _mm256_set1_ps(ray.inv_direction.y);
+    const __m256 iz = _mm256_set1_ps(ray.inv_direction.z);
+
+    __m256 near_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[sx][0]), ox), ix);
+    __m256 near_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[sy][1]), oy), iy);
+    __m256 near_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[sz][2]), oz), iz);
+    __m256 far_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[1 - sx][0]), ox), ix);
+    __m256 far_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[1 - sy][1]), oy), iy);
+    __m256 far_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[1 - sz][2]), oz), iz);
+
+    __m256 entry = _mm256_max_ps(_mm256_max_ps(near_x, near_y), _mm256_max_ps(near_z, _mm256_setzero_ps()));
+    __m256 exit = _mm256_min_ps(_mm256_min_ps(far_x, far_y), _mm256_min_ps(far_z, _mm256_set1_ps(max_t)));
+
+    _mm256_storeu_ps(t_near, entry);
+    return _mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ));
+#else
+    int mask = 0;
+    for (int k = 0; k < 8; ++k)
+    {
+        float near_x = (node.bounds[sx][0][k] - ray.origin.x) * ray.inv_direction.x;
+        float near_y = (node.bounds[sy][1][k] - ray.origin.y) * ray.inv_direction.y;
+        float near_z = (node.bounds[sz][2][k] - ray.origin.z) * ray.inv_direction.z;
+        float far_x = (node.bounds[1 - sx][0][k] - ray.origin.x) * ray.inv_direction.x;
+        float far_y = (node.bounds[1 - sy][1][k] - ray.origin.y) * ray.inv_direction.y;
+        float far_z = (node.bounds[1 - sz][2][k] - ray.origin.z) * ray.inv_direction.z;
+
+        float entry = std::max(std::max(near_x, near_y), std::max(near_z, 0.0f));
+        float exit = std::min(std::min(far_x, far_y), std::min(far_z, max_t));
+        t_near[k] = entry;
+        if (entry <= exit)
+            mask |= 1 << k;
+    }
+    return mask;
+#endif
+}
+
+bool BVH8::intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const
+{
+    if (nodes.empty())
+        return false;
+
+    float min_t = 1e30f;
+    const Triangle *closest_triangle = nullptr;
+
+    TraversalStack<StackEntry, STACK_SIZE> stack;
+    stack.push({0, 0, 0.0f});
+
+    while (!stack.empty())
+    {
+        StackEntry entry = stack.pop();
+        if (entry.t_near > min_t)
+            continue;
+
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.node; i < entry.node + entry.count; ++i)
+            {
+                float tri_t;
+                if (triangles[i]->intersect(ray, tri_t) && tri_t < min_t && tri_t > 0.001f)
+                {
+                    min_t = tri_t;
+                    closest_triangle = triangles[i];
+                }
+            }
+            continue;
+        }
+
+        const BVH8Node &node = nodes[entry.node];
+        alignas(32) float t_near[8];
+        int mask = intersect_children(node, ray, min_t, t_near);
+        if (!mask)
+            continue;
+
+        // Getroffene Kinder absteigend nach Distanz ablegen, das nächste liegt oben
+        StackEntry hits[8];
+        int hit_count = 0;
+        for (; mask; mask &= mask - 1)
+        {
+            int k = __builtin_ctz(mask);
+            StackEntry child = {node.child[k], node.count[k], t_near[k]};
+            int j = hit_count++;
+            while (j > 0 && hits[j - 1].t_near < child.t_near)
+            {
+                hits[j] = hits[j - 1];
+                --j;
+            }
+            hits[j] = child;
+        }
+        for (int k = 0; k < hit_count; ++k)
+        {
+            stack.push(hits[k]);
+        }
+    }
+
+    if (!closest_triangle)
+        return false;
+
+    t = min_t;
+    hit_triangle = closest_triangle;
+    return true;
+}
+
+bool BVH8::find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const
+{
+    occluder = nullptr;
+    if (nodes.empty())
+        return false;
+
+    TraversalStack<StackEntry, STACK_SIZE> stack;
+    stack.push({0, 0, 0.0f});
+
+    while (!stack.empty())
+    {
+        StackEntry entry = stack.pop();
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.node; i < entry.node + entry.count; ++i)
+            {
+                float t;
+                if (triangles[i]->intersect(ray, t) && t < t_max && t > 0.001f)
+                {
+                    occluder = triangles[i];
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        const BVH8Node &node = nodes[entry.node];
+        alignas(32) float t_near[8];
+        for (int mask = intersect_children(node, ray, t_max, t_near); mask; mask &= mask - 1)
+        {
+            int k = __builtin_ctz(mask);
+            stack.push({node.child[k], node.count[k], t_near[k]});
+        }
+    }
+    return false;
+}
+
+void BVH8::print_stats() const
+{
+    int leaf_count = 0;
+    int used_slots = 0;
+    for (const auto &node : nodes)
+    {
+        used_slots += node.child_count;
+        for (uint32_t k = 0; k < node.child_count; ++k)
+        {
+            if (node.count[k] > 0)
+                leaf_count++;
+        }
+    }
+
+    std::cout << "BVH8 Statistics:\n";
+    std::cout << "  Nodes: " << nodes.size() << " (" << nodes.size() * sizeof(BVH8Node) / 1024 << " KB)\n";
+    std::cout << "  Leaf slots: " << leaf_count << "\n";
+    std::cout << "  Average children per node: " << (float)used_slots / std::max<size_t>(nodes.size(), 1) << "\n";
+    std::cout << "  Average triangles per leaf: " << (float)triangles.size() / std::max(leaf_count, 1) << "\n";
+}
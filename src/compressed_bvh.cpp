@@ -0,0 +1,343 @@
+#include "../include/compressed_bvh.hpp"
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const int STACK_SIZE = 256;
+
+    struct StackEntry
+    {
+        uint32_t node;
+        uint32_t count; // > 0: Blatt mit count Dreiecken ab node
+        float t_near;
+    };
+
+    // 2^e direkt über die Exponentenbits, e in [-126, 127]
+    inline float power_of_two(int e)
+    {
+        uint32_t bits = static_cast<uint32_t>(e + 127) << 23;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // q * 2^e ist exakt, die Addition rundet einmal: überall dasselbe Ergebnis
+    inline float decode(float origin, float scale, int q)
+    {
+        return origin + static_cast<float>(q) * scale;
+    }
+
+    // Kleinste Zweierpotenz, mit der 255 Zellen die Box vollständig abdecken
+    int choose_exponent(float origin, float max)
+    {
+        float extent = max - origin;
+        int e = extent > 0.0f ? std::ilogb(extent / 255.0f) : -126;
+        e = std::max(e, -126);
+        while (e < 127 && decode(origin, power_of_two(e), 255) < max)
+            ++e;
+        return e;
+    }
+}
+
+// CompressedBVH8 Implementation
+void CompressedBVH8::build(const std::vector<Triangle> &input)
+{
+    std::cout << "Building Compressed BVH8 with " << input.size() << " triangles...\n";
+
+    nodes.clear();
+    triangles.clear();
+    root_bbox = BoundingBox();
+
+    BVH8 wide(false);
+    wide.build(input);
+    if (wide.get_nodes().empty())
+        return;
+
+    root_bbox = wide.bounds();
+    triangles.reserve(wide.get_triangles().size());
+    nodes.reserve(wide.get_nodes().size());
+    nodes.emplace_back();
+    compress(wide.get_nodes(), wide.get_triangles(), 0, 0);
+
+    std::cout << "Compressed BVH8 built successfully!\n";
+    print_stats();
+}
+
+void CompressedBVH8::compress(const std::vector<BVH8Node> &wide, const std::vector<const Triangle *> &wide_triangles,
+                              uint32_t wide_index, uint32_t out_index)
+{
+    const BVH8Node &src = wide[wide_index];
+    CompressedBVH8Node node;
+
+    // Knotenbox = Vereinigung der Kindboxen, daraus Ursprung und Zellgröße
+    float scale[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float lo = 1e30f, hi = -1e30f;
+        for (uint32_t k = 0; k < src.child_count; ++k)
+        {
+            lo = std::min(lo, src.bounds[0][axis][k]);
+            hi = std::max(hi, src.bounds[1][axis][k]);
+        }
+        int e = choose_exponent(lo, hi);
+        node.origin[axis] = lo;
+        node.exponent[axis] = static_cast<int8_t>(e);
+        scale[axis] = power_of_two(e);
+    }
+
+    node.inner_mask = 0;
+    node.child_base = static_cast<uint32_t>(nodes.size());
+    node.triangle_base = static_cast<uint32_t>(triangles.size());
+
+    uint32_t inner_children[8];
+    int inner_count = 0;
+    int leaf_offset = 0;
+    for (int k = 0; k < 8; ++k)
+    {
+        node.leaf_offset[k] = 0;
+        node.leaf_count[k] = 0;
+
+        if (k >= static_cast<int>(src.child_count))
+        {
+            // Leerer Slot: invertierte Box wird in der Traversierung immer verworfen
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                node.q_min[axis][k] = 255;
+                node.q_max[axis][k] = 0;
+            }
+            continue;
+        }
+
+        // Konservativ runden: dekodiertes Minimum <= echtes Minimum, Maximum >= echtes Maximum
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float o = node.origin[axis], s = scale[axis];
+            float child_min = src.bounds[0][axis][k];
+            float child_max = src.bounds[1][axis][k];
+
+            int q_lo = std::max(0, std::min(255, static_cast<int>(std::floor((child_min - o) / s))));
+            while (q_lo > 0 && decode(o, s, q_lo) > child_min)
+                --q_lo;
+            int q_hi = std::max(0, std::min(255, static_cast<int>(std::ceil((child_max - o) / s))));
+            while (q_hi < 255 && decode(o, s, q_hi) < child_max)
+                ++q_hi;
+
+            node.q_min[axis][k] = static_cast<uint8_t>(q_lo);
+            node.q_max[axis][k] = static_cast<uint8_t>(q_hi);
+        }
+
+        if (src.count[k] > 0)
+        {
+            // Blatt: Dreiecke hinter die der übrigen Blätter dieses Knotens kopieren
+            node.leaf_offset[k] = static_cast<uint8_t>(leaf_offset);
+            node.leaf_count[k] = static_cast<uint8_t>(src.count[k]);
+            for (uint32_t i = src.child[k]; i < src.child[k] + src.count[k]; ++i)
+            {
+                triangles.push_back(wide_triangles[i]);
+            }
+            leaf_offset += src.count[k];
+        }
+        else
+        {
+            node.inner_mask |= 1 << k;
+            inner_children[inner_count++] = src.child[k];
+        }
+    }
+
+    // Innere Kinder zusammenhängend reservieren, dann rekursiv füllen
+    for (int i = 0; i < inner_count; ++i)
+    {
+        nodes.emplace_back();
+    }
+    nodes[out_index] = node;
+
+    for (int i = 0; i < inner_count; ++i)
+    {
+        compress(wide, wide_triangles, inner_children[i], node.child_base + i);
+    }
+}
+
+// Dekodiert die acht Kindboxen und testet sie gegen den Strahl
+int CompressedBVH8::intersect_children(const CompressedBVH8Node &node, const Ray &ray, float max_t, float *t_near) const
+{
+    const int sx = ray.sign[0], sy = ray.sign[1], sz = ray.sign[2];
+    const uint8_t *near_x = sx ? node.q_max[0] : node.q_min[0];
+    const uint8_t *near_y = sy ? node.q_max[1] : node.q_min[1];
+    const uint8_t *near_z = sz ? node.q_max[2] : node.q_min[2];
+    const uint8_t *far_x = sx ? node.q_min[0] : node.q_max[0];
+    const uint8_t *far_y = sy ? node.q_min[1] : node.q_max[1];
+    const uint8_t *far_z = sz ? node.q_min[2] : node.q_max[2];
+
+    const float scale_x = power_of_two(node.exponent[0]);
+    const float scale_y = power_of_two(node.exponent[1]);
+    const float scale_z = power_of_two(node.exponent[2]);
+
+#if defined(__AVX2__)
+    auto plane = [](const uint8_t *q, float origin, float scale, float ray_origin, float inv_dir)
+    {
+        __m256 qf = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(q))));
+        __m256 coord = _mm256_add_ps(_mm256_mul_ps(qf, _mm256_set1_ps(scale)), _mm256_set1_ps(origin));
+        return _mm256_mul_ps(_mm256_sub_ps(coord, _mm256_set1_ps(ray_origin)), _mm256_set1_ps(inv_dir));
+    };
+
+    __m256 entry = _mm256_max_ps(
+        _mm256_max_ps(plane(near_x, node.origin[0], scale_x, ray.origin.x, ray.inv_direction.x),
+                      plane(near_y, node.origin[1], scale_y, ray.origin.y, ray.inv_direction.y)),
+        _mm256_max_ps(plane(near_z, node.origin[2], scale_z, ray.origin.z, ray.inv_direction.z), _mm256_setzero_ps()));
+    __m256 exit = _mm256_min_ps(
+        _mm256_min_ps(plane(far_x, node.origin[0], scale_x, ray.origin.x, ray.inv_direction.x),
+                      plane(far_y, node.origin[1], scale_y, ray.origin.y, ray.inv_direction.y)),
+        _mm256_min_ps(plane(far_z, node.origin[2], scale_z, ray.origin.z, ray.inv_direction.z), _mm256_set1_ps(max_t)));
+
+    _mm256_storeu_ps(t_near, entry);
+    return _mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ));
+#else
+    int mask = 0;
+    for (int k = 0; k < 8; ++k)
+    {
+        float entry = std::max(
+            std::max((decode(node.origin[0], scale_x, near_x[k]) - ray.origin.x) * ray.inv_direction.x,
+                     (decode(node.origin[1], scale_y, near_y[k]) - ray.origin.y) * ray.inv_direction.y),
+            std::max((decode(node.origin[2], scale_z, near_z[k]) - ray.origin.z) * ray.inv_direction.z, 0.0f));
+        float exit = std::min(
+            std::min((decode(node.origin[0], scale_x, far_x[k]) - ray.origin.x) * ray.inv_direction.x,
+                     (decode(node.origin[1], scale_y, far_y[k]) - ray.origin.y) * ray.inv_direction.y),
+            std::min((decode(node.origin[2], scale_z, far_z[k]) - ray.origin.z) * ray.inv_direction.z, max_t));
+        t_near[k] = entry;
+        if (entry <= exit)
+            mask |= 1 << k;
+    }
+    return mask;
+#endif
+}
+
+bool CompressedBVH8::intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const
+{
+    if (nodes.empty())
+        return false;
+
+    float min_t = 1e30f;
+    const Triangle *closest_triangle = nullptr;
+
+    TraversalStack<StackEntry, STACK_SIZE> stack;
+    stack.push({0, 0, 0.0f});
+
+    while (!stack.empty())
+    {
+        StackEntry entry = stack.pop();
+        if (entry.t_near > min_t)
+            continue;
+
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.node; i < entry.node + entry.count; ++i)
+            {
+                float tri_t;
+                if (triangles[i]->intersect(ray, tri_t) && tri_t < min_t && tri_t > 0.001f)
+                {
+                    min_t = tri_t;
+                    closest_triangle = triangles[i];
+                }
+            }
+            continue;
+        }
+
+        const CompressedBVH8Node &node = nodes[entry.node];
+        alignas(32) float t_near[8];
+        int mask = intersect_children(node, ray, min_t, t_near);
+
+        // Getroffene Kinder absteigend nach Distanz ablegen, das nächste liegt oben
+        StackEntry hits[8];
+        int hit_count = 0;
+        for (; mask; mask &= mask - 1)
+        {
+            int k = __builtin_ctz(mask);
+            StackEntry child;
+            if (node.inner_mask & (1 << k))
+                child = {node.child_base + __builtin_popcount(node.inner_mask & ((1u << k) - 1)), 0, t_near[k]};
+            else if (node.leaf_count[k] > 0)
+                child = {node.triangle_base + node.leaf_offset[k], node.leaf_count[k], t_near[k]};
+            else
+                continue;
+
+            int j = hit_count++;
+            while (j > 0 && hits[j - 1].t_near < child.t_near)
+            {
+                hits[j] = hits[j - 1];
+                --j;
+            }
+            hits[j] = child;
+        }
+        for (int k = 0; k < hit_count; ++k)
+        {
+            stack.push(hits[k]);
+        }
+    }
+
+    if (!closest_triangle)
+        return false;
+
+    t = min_t;
+    hit_triangle = closest_triangle;
+    return true;
+}
+
+bool CompressedBVH8::find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const
+{
+    occluder = nullptr;
+    if (nodes.empty())
+        return false;
+
+    TraversalStack<StackEntry, STACK_SIZE> stack;
+    stack.push({0, 0, 0.0f});
+
+    while (!stack.empty())
+    {
+        StackEntry entry = stack.pop();
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.node; i < entry.node + entry.count; ++i)
+            {
+                float t;
+                if (triangles[i]->intersect(ray, t) && t < t_max && t > 0.001f)
+                {
+                    occluder = triangles[i];
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        const CompressedBVH8Node &node = nodes[entry.node];
+        alignas(32) float t_near[8];
+        for (int mask = intersect_children(node, ray, t_max, t_near); mask; mask &= mask - 1)
+        {
+            int k = __builtin_ctz(mask);
+            if (node.inner_mask & (1 << k))
+                stack.push({node.child_base + __builtin_popcount(node.inner_mask & ((1u << k) - 1)), 0, t_near[k]});
+            else if (node.leaf_count[k] > 0)
+                stack.push({node.triangle_base + node.leaf_offset[k], node.leaf_count[k], t_near[k]});
+        }
+    }
+    return false;
+}
+
+void CompressedBVH8::print_stats() const
+{
+    size_t bytes = nodes.size() * sizeof(CompressedBVH8Node);
+    size_t uncompressed = nodes.size() * sizeof(BVH8Node);
+
+    std::cout << "Compressed BVH8 Statistics:\n";
+    std::cout << "  Nodes: " << nodes.size() << " (" << bytes / 1024 << " KB, "
+              << sizeof(CompressedBVH8Node) << " Bytes pro Knoten)\n";
+    std::cout << "  Uncompressed BVH8: " << uncompressed / 1024 << " KB ("
+              << sizeof(BVH8Node) << " Bytes pro Knoten)\n";
+    std::cout << "  Triangles: " << triangles.size() << "\n";
+}
@@ -0,0 +1,304 @@
+#include "../include/distributed.hpp"
+#include "../include/progress.hpp"
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+TileCoordinator::TileCoordinator(int w, int h, int tile_size)
+    : width(w), height(h), tile_size(std::max(1, tile_size))
+{
+}
+
+#ifdef _WIN32
+
+void run_tile_worker(int, int, const Accelerator &, const Camera &, const LightTree &, const PathSettings &)
+{
+    throw std::runtime_error("Verteiltes Rendering wird nur unter POSIX unterstützt");
+}
+
+void TileCoordinator::render(Image &, int, const std::function<void(int, int)> &)
+{
+    throw std::runtime_error("Verteiltes Rendering wird nur unter POSIX unterstützt");
+}
+
+#else
+
+namespace
+{
+// Liest bzw. schreibt genau size Bytes, false bei Fehler oder Ende der Pipe
+bool read_full(int fd, void *data, size_t size)
+{
+    char *p = static_cast<char *>(data);
+    while (size > 0)
+    {
+        ssize_t n = ::read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool write_full(int fd, const void *data, size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+struct WorkerProcess
+{
+    pid_t pid;
+    int to_worker;   // Kacheln zum Worker
+    int from_worker; // Pixel vom Worker
+    bool alive;
+    bool busy;
+    TileRequest tile;
+};
+}
+
+void run_tile_worker(int in_fd, int out_fd, const Accelerator &accel, const Camera &cam,
+                     const LightTree &lights, const PathSettings &settings)
+{
+    std::vector<unsigned char> pixels;
+    std::vector<float> dx, dy, dz;
+    TileRequest tile;
+    while (read_full(in_fd, &tile, sizeof(tile)) && tile.width > 0)
+    {
+        // Pixelmitte und Pfad-Startwert wie in render_kdtree, das Bild ist also identisch
+        pixels.resize(static_cast<size_t>(tile.width) * tile.height * 3);
+        unsigned char *out = pixels.data();
+        dx.resize(tile.width);
+        dy.resize(tile.width);
+        dz.resize(tile.width);
+        for (int y = tile.y; y < tile.y + tile.height; ++y)
+        {
+            cam.row_directions(y, tile.x, tile.width, dx.data(), dy.data(), dz.data());
+            for (int x = tile.x; x < tile.x + tile.width; ++x)
+            {
+                int k = x - tile.x;
+                Ray ray = Ray::with_unit_direction(cam.eye, Vector3(dx[k], dy[k], dz[k]));
+                uint32_t rng = path_seed(y * cam.width_px + x);
+                Vector3 color = trace_kdtree(ray, accel, cam, lights, settings, rng);
+                Color c(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z));
+                *out++ = c.r;
+                *out++ = c.g;
+                *out++ = c.b;
+            }
+        }
+
+        if (!write_full(out_fd, &tile, sizeof(tile)) || !write_full(out_fd, pixels.data(), pixels.size()))
+            break;
+    }
+}
+
+void TileCoordinator::render(Image &img, int worker_count, const std::function<void(int, int)> &child_main)
+{
+    std::cout << "Verteiltes Rendering mit " << worker_count << " Workern gestartet...\n";
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Schreiben in eine Pipe ohne Leser soll einen Fehler liefern statt den Prozess zu beenden
+    signal(SIGPIPE, SIG_IGN);
+
+    std::deque<TileRequest> pending;
+    for (int y = 0; y < height; y += tile_size)
+    {
+        for (int x = 0; x < width; x += tile_size)
+            pending.push_back({x, y, std::min(tile_size, width - x), std::min(tile_size, height - y)});
+    }
+    const size_t tile_count = pending.size();
+
+    std::vector<WorkerProcess> workers;
+    for (int i = 0; i < worker_count; ++i)
+    {
+        int request_pipe[2], result_pipe[2];
+        if (pipe(request_pipe) != 0 || pipe(result_pipe) != 0)
+            throw std::runtime_error("Pipe für Worker konnte nicht angelegt werden");
+
+        // Sonst schreibt jedes Kind den noch gepufferten Text erneut
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid < 0)
+            throw std::runtime_error("Worker-Prozess konnte nicht gestartet werden");
+        if (pid == 0)
+        {
+            // Kind: nur die eigenen Enden behalten, sonst bemerkt der Koordinator
+            // das Ende eines anderen Workers nicht
+            for (const WorkerProcess &other : workers)
+            {
+                close(other.to_worker);
+                close(other.from_worker);
+            }
+            close(request_pipe[1]);
+            close(result_pipe[0]);
+            child_main(request_pipe[0], result_pipe[1]);
+            _exit(0);
+        }
+
+        close(request_pipe[0]);
+        close(result_pipe[1]);
+        workers.push_back({pid, request_pipe[1], result_pipe[0], true, false, {0, 0, 0, 0}});
+    }
+
+    // Erst nach dem Start der Worker, damit kein Thread mitgeforkt wird
+    ProgressReporter progress("Verteilt", tile_count);
+    size_t finished = 0, reassigned = 0;
+    std::vector<unsigned char> pixels;
+
+    auto retire = [&](WorkerProcess &worker)
+    {
+        if (!worker.alive)
+            return;
+        worker.alive = false;
+        if (worker.busy)
+        {
+            pending.push_front(worker.tile);
+            ++reassigned;
+            worker.busy = false;
+        }
+        close(worker.to_worker);
+        close(worker.from_worker);
+        waitpid(worker.pid, nullptr, 0);
+        progress.log("Warnung: Worker " + std::to_string(worker.pid) + " beendet, offene Kachel wird neu vergeben");
+    };
+
+    auto assign = [&]()
+    {
+        for (WorkerProcess &worker : workers)
+        {
+            if (!worker.alive || worker.busy || pending.empty())
+                continue;
+            worker.tile = pending.front();
+            pending.pop_front();
+            worker.busy = true;
+            if (!write_full(worker.to_worker, &worker.tile, sizeof(TileRequest)))
+                retire(worker);
+        }
+    };
+
+    assign();
+    while (finished < tile_count)
+    {
+        std::vector<pollfd> fds;
+        std::vector<size_t> owners;
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            if (workers[i].alive && workers[i].busy)
+            {
+                fds.push_back({workers[i].from_worker, POLLIN, 0});
+                owners.push_back(i);
+            }
+        }
+        if (fds.empty())
+        {
+            // Alle Worker tot: auch die Kinder der verbliebenen Einträge einsammeln
+            for (WorkerProcess &worker : workers)
+                retire(worker);
+            throw std::runtime_error("Alle Worker sind ausgefallen, " + std::to_string(tile_count - finished) +
+                                     " Kacheln fehlen");
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("poll auf die Worker-Pipes ist fehlgeschlagen");
+        }
+
+        for (size_t k = 0; k < fds.size(); ++k)
+        {
+            if (fds[k].revents == 0)
+                continue;
+
+            WorkerProcess &worker = workers[owners[k]];
+            TileRequest tile;
+            pixels.resize(static_cast<size_t>(worker.tile.width) * worker.tile.height * 3);
+            if (!read_full(worker.from_worker, &tile, sizeof(tile)) ||
+                tile.x != worker.tile.x || tile.y != worker.tile.y ||
+                !read_full(worker.from_worker, pixels.data(), pixels.size()))
+            {
+                retire(worker);
+                continue;
+            }
+
+            const unsigned char *in = pixels.data();
+            for (int y = tile.y; y < tile.y + tile.height; ++y)
+            {
+                for (int x = tile.x; x < tile.x + tile.width; ++x, in += 3)
+                    img.set_pixel(x, y, Color(in[0], in[1], in[2]));
+            }
+            worker.busy = false;
+            ++finished;
+            progress.advance(1, static_cast<uint64_t>(tile.width) * tile.height);
+        }
+        assign();
+    }
+
+    // Worker beenden
+    TileRequest stop = {0, 0, 0, 0};
+    for (WorkerProcess &worker : workers)
+    {
+        if (!worker.alive)
+            continue;
+        write_full(worker.to_worker, &stop, sizeof(stop));
+        close(worker.to_worker);
+        close(worker.from_worker);
+        waitpid(worker.pid, nullptr, 0);
+    }
+
+    progress.finish();
+
+    std::chrono::duration<double> render_time = std::chrono::high_resolution_clock::now() - start;
+    std::cout << "Verteilte Renderzeit: " << render_time.count() << " Sekunden, " << tile_count << " Kacheln";
+    if (reassigned > 0)
+        std::cout << ", " << reassigned << " neu vergeben";
+    std::cout << "\n";
+}
+
+#endif
+
+void TileCoordinator::render_forked(Image &img, int worker_count, const std::function<void(int, int)> &worker)
+{
+    render(img, worker_count, worker);
+}
+
+void TileCoordinator::render_spawned(Image &img, int worker_count, const std::vector<std::string> &command)
+{
+    render(img, worker_count, [&command](int in_fd, int out_fd)
+           {
+#ifndef _WIN32
+        std::vector<std::string> args = command;
+        args.push_back(std::to_string(in_fd));
+        args.push_back(std::to_string(out_fd));
+        std::vector<char *> argv;
+        for (std::string &arg : args)
+            argv.push_back(&arg[0]);
+        argv.push_back(nullptr);
+        execvp(argv[0], argv.data());
+        // Nur bei Fehlern erreicht; der Koordinator sieht das Ende der Pipe
+        _exit(127);
+#endif
+    });
+}
@@ -0,0 +1,265 @@
+#include "../include/grid.hpp"
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+// Grid Implementation
+Grid::Grid(float density, bool hierarchical, int max_cell_triangles)
+    : density(std::max(density, 0.01f)), hierarchical(hierarchical), max_cell_triangles(std::max(max_cell_triangles, 1))
+{
+}
+
+void Grid::build(const std::vector<Triangle> &triangles)
+{
+    std::cout << "Building " << name() << " with " << triangles.size() << " triangles...\n";
+
+    subgrids.clear();
+    top = GridLevel();
+    if (triangles.empty())
+        return;
+
+    std::vector<const Triangle *> triangle_ptrs;
+    triangle_ptrs.reserve(triangles.size());
+    BoundingBox bbox;
+    for (const auto &tri : triangles)
+    {
+        triangle_ptrs.push_back(&tri);
+        bbox.expand(tri.v0);
+        bbox.expand(tri.v1);
+        bbox.expand(tri.v2);
+    }
+
+    // Flache Szenen leicht aufweiten, damit jede Achse ein Volumen hat
+    Vector3 extent = bbox.max - bbox.min;
+    float pad = 1e-5f * std::max({extent.x, extent.y, extent.z}) + 1e-6f;
+    bbox.min = bbox.min - Vector3(pad, pad, pad);
+    bbox.max = bbox.max + Vector3(pad, pad, pad);
+
+    build_level(top, triangle_ptrs, bbox, density);
+    top.child.assign(top.cell_start.size() - 1, -1);
+
+    if (hierarchical)
+    {
+        // Überfüllte Zellen bekommen ein eigenes Gitter über ihre Dreiecke
+        for (int z = 0; z < top.res[2]; ++z)
+        {
+            for (int y = 0; y < top.res[1]; ++y)
+            {
+                for (int x = 0; x < top.res[0]; ++x)
+                {
+                    int c = top.cell_index(x, y, z);
+                    uint32_t count = top.cell_start[c + 1] - top.cell_start[c];
+                    if (count <= static_cast<uint32_t>(max_cell_triangles))
+                        continue;
+
+                    Point3 cell_min(top.bbox.min.x + x * top.cell_size.x,
+                                    top.bbox.min.y + y * top.cell_size.y,
+                                    top.bbox.min.z + z * top.cell_size.z);
+                    BoundingBox cell_bbox(cell_min, cell_min + top.cell_size);
+                    std::vector<const Triangle *> cell_triangles(top.refs.begin() + top.cell_start[c],
+                                                                 top.refs.begin() + top.cell_start[c + 1]);
+
+                    GridLevel sub;
+                    build_level(sub, cell_triangles, cell_bbox, density);
+                    top.child[c] = static_cast<int32_t>(subgrids.size());
+                    subgrids.push_back(std::move(sub));
+                }
+            }
+        }
+    }
+
+    std::cout << name() << " built successfully!\n";
+    print_stats();
+}
+
+void Grid::build_level(GridLevel &level, const std::vector<const Triangle *> &triangles,
+                       const BoundingBox &bbox, float level_density) const
+{
+    level.bbox = bbox;
+
+    // Auflösung nach Dreiecksdichte: etwa level_density Zellen pro Dreieck,
+    // Zellen möglichst würfelförmig
+    Vector3 extent = bbox.max - bbox.min;
+    float volume = extent.x * extent.y * extent.z;
+    float cells_per_unit = std::cbrt(level_density * triangles.size() / std::max(volume, 1e-30f));
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        level.res[axis] = std::max(1, std::min(256, static_cast<int>(std::ceil(extent[axis] * cells_per_unit))));
+    }
+
+    level.cell_size = Vector3(extent.x / level.res[0], extent.y / level.res[1], extent.z / level.res[2]);
+    level.inv_cell_size = Vector3(1.0f / level.cell_size.x, 1.0f / level.cell_size.y, 1.0f / level.cell_size.z);
+
+    // Zellbereich eines Dreiecks über seine Bounding Box
+    auto cell_range = [&](const Triangle *tri, int lo[3], int hi[3])
+    {
+        BoundingBox tri_bbox;
+        tri_bbox.expand(tri->v0);
+        tri_bbox.expand(tri->v1);
+        tri_bbox.expand(tri->v2);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            lo[axis] = static_cast<int>((tri_bbox.min[axis] - bbox.min[axis]) * level.inv_cell_size[axis]);
+            hi[axis] = static_cast<int>((tri_bbox.max[axis] - bbox.min[axis]) * level.inv_cell_size[axis]);
+            lo[axis] = std::max(0, std::min(level.res[axis] - 1, lo[axis]));
+            hi[axis] = std::max(0, std::min(level.res[axis] - 1, hi[axis]));
+        }
+    };
+
+    // Zwei Durchläufe (Zählen, Einsortieren): Aufbau in O(N)
+    size_t cell_count = static_cast<size_t>(level.res[0]) * level.res[1] * level.res[2];
+    level.cell_start.assign(cell_count + 1, 0);
+    int lo[3], hi[3];
+    for (const Triangle *tri : triangles)
+    {
+        cell_range(tri, lo, hi);
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    level.cell_start[level.cell_index(x, y, z) + 1]++;
+    }
+    for (size_t c = 0; c < cell_count; ++c)
+    {
+        level.cell_start[c + 1] += level.cell_start[c];
+    }
+
+    level.refs.resize(level.cell_start[cell_count]);
+    std::vector<uint32_t> fill(level.cell_start.begin(), level.cell_start.end() - 1);
+    for (const Triangle *tri : triangles)
+    {
+        cell_range(tri, lo, hi);
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    level.refs[fill[level.cell_index(x, y, z)]++] = tri;
+    }
+}
+
+bool Grid::intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const
+{
+    float t_enter, t_exit;
+    if (top.refs.empty() || !top.bbox.intersect(ray, t_enter, t_exit))
+        return false;
+
+    float best_t = 1e30f;
+    const Triangle *best_triangle = nullptr;
+    traverse(top, ray, t_enter, t_exit, false, best_t, best_triangle);
+    if (!best_triangle)
+        return false;
+
+    t = best_t;
+    hit_triangle = best_triangle;
+    return true;
+}
+
+bool Grid::find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const
+{
+    occluder = nullptr;
+    float t_enter, t_exit;
+    if (top.refs.empty() || !top.bbox.intersect(ray, t_enter, t_exit) || t_enter > t_max)
+        return false;
+
+    float best_t = t_max;
+    return traverse(top, ray, t_enter, std::min(t_exit, t_max), true, best_t, occluder);
+}
+
+// 3D-DDA durch eine Gitterebene im Intervall [t_enter, t_exit].
+// Liefert true, sobald ein Treffer feststeht (any_hit: irgendeiner, sonst der nächste).
+bool Grid::traverse(const GridLevel &level, const Ray &ray, float t_enter, float t_exit, bool any_hit,
+                    float &best_t, const Triangle *&best_triangle) const
+{
+    Point3 entry = ray.origin + ray.direction * t_enter;
+
+    int cell[3], step[3], end[3];
+    float t_next[3], t_delta[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        int c = static_cast<int>((entry[axis] - level.bbox.min[axis]) * level.inv_cell_size[axis]);
+        cell[axis] = std::max(0, std::min(level.res[axis] - 1, c));
+
+        float inv = ray.inv_direction[axis];
+        if (ray.sign[axis])
+        {
+            step[axis] = -1;
+            end[axis] = -1;
+            t_next[axis] = (level.bbox.min[axis] + cell[axis] * level.cell_size[axis] - ray.origin[axis]) * inv;
+        }
+        else
+        {
+            step[axis] = 1;
+            end[axis] = level.res[axis];
+            t_next[axis] = (level.bbox.min[axis] + (cell[axis] + 1) * level.cell_size[axis] - ray.origin[axis]) * inv;
+        }
+        t_delta[axis] = level.cell_size[axis] * std::abs(inv);
+    }
+
+    float t_cell_enter = t_enter;
+    while (true)
+    {
+        int c = level.cell_index(cell[0], cell[1], cell[2]);
+        float t_cell_exit = std::min(std::min(t_next[0], t_next[1]), std::min(t_next[2], t_exit));
+
+        if (!level.child.empty() && level.child[c] >= 0)
+        {
+            if (traverse(subgrids[level.child[c]], ray, t_cell_enter, t_cell_exit, any_hit, best_t, best_triangle) && any_hit)
+                return true;
+        }
+        else
+        {
+            for (uint32_t i = level.cell_start[c]; i < level.cell_start[c + 1]; ++i)
+            {
+                float t;
+                if (level.refs[i]->intersect(ray, t) && t < best_t && t > 0.001f)
+                {
+                    best_t = t;
+                    best_triangle = level.refs[i];
+                    if (any_hit)
+                        return true;
+                }
+            }
+        }
+
+        // Treffer innerhalb der aktuellen Zelle kann nicht mehr unterboten werden
+        if (best_triangle && best_t <= t_cell_exit)
+            return true;
+
+        int axis = (t_next[0] < t_next[1]) ? (t_next[0] < t_next[2] ? 0 : 2) : (t_next[1] < t_next[2] ? 1 : 2);
+        if (t_next[axis] > t_exit)
+            break;
+
+        cell[axis] += step[axis];
+        if (cell[axis] == end[axis])
+            break;
+
+        t_cell_enter = t_next[axis];
+        t_next[axis] += t_delta[axis];
+    }
+
+    return best_triangle != nullptr && !any_hit;
+}
+
+void Grid::print_stats() const
+{
+    size_t cell_count = top.cell_start.empty() ? 0 : top.cell_start.size() - 1;
+    size_t empty_cells = 0;
+    for (size_t c = 0; c < cell_count; ++c)
+    {
+        if (top.cell_start[c] == top.cell_start[c + 1])
+            empty_cells++;
+    }
+
+    size_t sub_refs = 0;
+    for (const auto &sub : subgrids)
+    {
+        sub_refs += sub.refs.size();
+    }
+
+    std::cout << "Grid Statistics:\n";
+    std::cout << "  Resolution: " << top.res[0] << " x " << top.res[1] << " x " << top.res[2] << "\n";
+    std::cout << "  Cells: " << cell_count << " (" << (cell_count ? 100.0f * empty_cells / cell_count : 0.0f) << "% leer)\n";
+    std::cout << "  Triangle references: " << top.refs.size() << "\n";
+    if (hierarchical)
+    {
+        std::cout << "  Subgrids: " << subgrids.size() << " (" << sub_refs << " references)\n";
+    }
+}
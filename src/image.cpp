@@ -0,0 +1,181 @@
+#include "../include/image.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cctype>
+
+namespace
+{
+std::ofstream open_output(const std::string &filename)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Bilddatei konnte nicht geöffnet werden: " + filename);
+    return file;
+}
+
+void close_output(std::ofstream &file, const std::string &filename)
+{
+    file.close();
+    if (!file)
+        throw std::runtime_error("Fehler beim Schreiben von " + filename);
+}
+
+void put_u32_be(std::vector<unsigned char> &out, uint32_t v)
+{
+    out.push_back(static_cast<unsigned char>(v >> 24));
+    out.push_back(static_cast<unsigned char>(v >> 16));
+    out.push_back(static_cast<unsigned char>(v >> 8));
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+std::string lower_extension(const std::string &filename)
+{
+    size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos || filename.find_first_of("/\\", dot) != std::string::npos)
+        return "";
+    std::string ext = filename.substr(dot + 1);
+    for (char &c : ext)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return ext;
+}
+}
+
+void Image::save_ppm(const std::string &filename) const
+{
+    static_assert(sizeof(Color) == 3, "Color muss drei Bytes RGB belegen");
+    std::ofstream file = open_output(filename);
+    std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    file.write(header.data(), header.size());
+    file.write(reinterpret_cast<const char *>(pixels.data()), static_cast<std::streamsize>(pixels.size() * 3));
+    close_output(file, filename);
+}
+
+void Image::save_qoi(const std::string &filename) const
+{
+    // Kodierung nach der QOI-Spezifikation 1.0, nur RGB (Alpha bleibt 255)
+    const unsigned char OP_INDEX = 0x00, OP_DIFF = 0x40, OP_LUMA = 0x80, OP_RUN = 0xc0, OP_RGB = 0xfe;
+
+    std::vector<unsigned char> out;
+    out.reserve(14 + pixels.size() * 4 + 8);
+    out.insert(out.end(), {'q', 'o', 'i', 'f'});
+    put_u32_be(out, static_cast<uint32_t>(width));
+    put_u32_be(out, static_cast<uint32_t>(height));
+    out.push_back(3); // Kanäle
+    out.push_back(0); // sRGB
+
+    Color index[64];
+    bool index_used[64] = {};
+    Color prev(0, 0, 0);
+    int run = 0;
+    const size_t count = pixels.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Color &px = pixels[i];
+        if (px.r == prev.r && px.g == prev.g && px.b == prev.b)
+        {
+            ++run;
+            if (run == 62 || i + 1 == count)
+            {
+                out.push_back(static_cast<unsigned char>(OP_RUN | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0)
+        {
+            out.push_back(static_cast<unsigned char>(OP_RUN | (run - 1)));
+            run = 0;
+        }
+
+        // Alpha ist immer 255, geht aber in den Hash ein
+        int slot = (px.r * 3 + px.g * 5 + px.b * 7 + 255 * 11) % 64;
+        const Color &cached = index[slot];
+        if (index_used[slot] && cached.r == px.r && cached.g == px.g && cached.b == px.b)
+        {
+            out.push_back(static_cast<unsigned char>(OP_INDEX | slot));
+        }
+        else
+        {
+            index[slot] = px;
+            index_used[slot] = true;
+
+            // Differenzen modulo 256 wie im Dekoder
+            int dr = static_cast<signed char>(px.r - prev.r);
+            int dg = static_cast<signed char>(px.g - prev.g);
+            int db = static_cast<signed char>(px.b - prev.b);
+            int dr_dg = dr - dg, db_dg = db - dg;
+
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+            {
+                out.push_back(static_cast<unsigned char>(OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+            }
+            else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+            {
+                out.push_back(static_cast<unsigned char>(OP_LUMA | (dg + 32)));
+                out.push_back(static_cast<unsigned char>((dr_dg + 8) << 4 | (db_dg + 8)));
+            }
+            else
+            {
+                out.insert(out.end(), {OP_RGB, px.r, px.g, px.b});
+            }
+        }
+        prev = px;
+    }
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+
+    std::ofstream file = open_output(filename);
+    file.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size()));
+    close_output(file, filename);
+}
+
+void Image::write_raw(std::FILE *out) const
+{
+    if (std::fwrite(pixels.data(), 3, pixels.size(), out) != pixels.size() || std::fflush(out) != 0)
+        throw std::runtime_error("Fehler beim Schreiben der Rohdaten");
+}
+
+void Image::save(const std::string &filename, const PngOptions &options) const
+{
+    if (filename == "-")
+    {
+        write_raw(stdout);
+        return;
+    }
+
+    std::string ext = lower_extension(filename);
+    if (ext == "png")
+        save_png(filename, options);
+    else if (ext == "ppm")
+        save_ppm(filename);
+    else if (ext == "qoi")
+        save_qoi(filename);
+    else
+        throw std::runtime_error("Unbekanntes Bildformat: " + filename);
+}
+
+void AccumulationBuffer::save_pfm(const std::string &filename, float scale) const
+{
+    // Negativer Maßstab im Kopf kennzeichnet Little Endian
+    uint32_t probe = 1;
+    unsigned char first_byte;
+    std::memcpy(&first_byte, &probe, 1);
+    if (first_byte != 1)
+        throw std::runtime_error("PFM-Export setzt eine Little-Endian-Maschine voraus");
+
+    std::ofstream file = open_output(filename);
+    std::string header = "PF\n" + std::to_string(width) + " " + std::to_string(height) + "\n-1.0\n";
+    file.write(header.data(), header.size());
+
+    // PFM beginnt wie der Puffer mit der untersten Zeile
+    std::vector<float> row(3 * static_cast<size_t>(width));
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            for (int channel = 0; channel < 3; ++channel)
+                row[3 * x + channel] = mean(x, y, channel) * scale;
+        }
+        file.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(float)));
+    }
+    close_output(file, filename);
+}
@@ -0,0 +1,193 @@
+#include "../include/instance.hpp"
+#include <algorithm>
+#include <iostream>
+
+// InstancedScene Implementation
+void InstancedScene::add_instance(const Accelerator &blas, const Transform &object_to_world)
+{
+    Instance instance;
+    instance.blas = &blas;
+    instance.object_to_world = object_to_world;
+    instance.world_to_object = object_to_world.inverse();
+
+    // Weltbox aus den acht transformierten Ecken der Objektbox
+    BoundingBox object_bbox = blas.bounds();
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        Point3 p((corner & 1) ? object_bbox.max.x : object_bbox.min.x,
+                 (corner & 2) ? object_bbox.max.y : object_bbox.min.y,
+                 (corner & 4) ? object_bbox.max.z : object_bbox.min.z);
+        instance.world_bbox.expand(object_to_world.apply_point(p));
+    }
+
+    instances.push_back(instance);
+}
+
+void InstancedScene::build_top_level()
+{
+    std::cout << "Building top level over " << instances.size() << " instances...\n";
+
+    nodes.clear();
+    instance_order.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        instance_order[i] = static_cast<uint32_t>(i);
+    }
+    if (instances.empty())
+        return;
+
+    nodes.reserve(2 * instances.size());
+    nodes.emplace_back();
+    build_recursive(0, 0, static_cast<uint32_t>(instances.size()));
+
+    print_stats();
+}
+
+void InstancedScene::build_recursive(uint32_t node_index, uint32_t first, uint32_t count)
+{
+    BoundingBox bbox;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        bbox.expand(instances[instance_order[i]].world_bbox);
+    }
+    nodes[node_index].bbox = bbox;
+    nodes[node_index].left_first = first;
+    nodes[node_index].count = count;
+
+    if (count <= 1)
+        return;
+
+    // Wenige Instanzen: Median-Teilung entlang der längsten Achse genügt
+    int axis = bbox.longest_axis();
+    uint32_t mid = first + count / 2;
+    std::nth_element(instance_order.begin() + first, instance_order.begin() + mid, instance_order.begin() + first + count,
+                     [&](uint32_t a, uint32_t b)
+                     {
+                         const BoundingBox &ba = instances[a].world_bbox;
+                         const BoundingBox &bb = instances[b].world_bbox;
+                         return ba.min[axis] + ba.max[axis] < bb.min[axis] + bb.max[axis];
+                     });
+
+    uint32_t left = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[node_index].left_first = left;
+    nodes[node_index].count = 0;
+
+    build_recursive(left, first, mid - first);
+    build_recursive(left + 1, mid, first + count - mid);
+}
+
+// Der Ray-Konstruktor normiert die Richtung; t_scale rechnet Objekt- in Weltdistanzen um
+Ray InstancedScene::to_object_space(const Instance &instance, const Ray &ray, float &t_scale) const
+{
+    Vector3 direction = instance.world_to_object.apply_vector(ray.direction);
+    t_scale = direction.length();
+    return Ray(instance.world_to_object.apply_point(ray.origin), direction);
+}
+
+bool InstancedScene::intersect(const Ray &ray, float &t, const Triangle *&hit_triangle) const
+{
+    Hit hit;
+    if (!intersect_hit(ray, hit))
+        return false;
+
+    t = hit.t;
+    hit_triangle = hit.triangle;
+    return true;
+}
+
+bool InstancedScene::intersect_hit(const Ray &ray, Hit &hit) const
+{
+    if (nodes.empty())
+        return false;
+
+    bool found = false;
+    uint32_t stack[64];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const BVHNode &node = nodes[stack[--sp]];
+        float t_min, t_max;
+        if (!node.bbox.intersect(ray, t_min, t_max) || t_min > hit.t)
+            continue;
+
+        if (!node.is_leaf())
+        {
+            stack[sp++] = node.left_first + 1;
+            stack[sp++] = node.left_first;
+            continue;
+        }
+
+        for (uint32_t i = node.left_first; i < node.left_first + node.count; ++i)
+        {
+            const Instance &instance = instances[instance_order[i]];
+            float t_scale;
+            Ray object_ray = to_object_space(instance, ray, t_scale);
+
+            Hit object_hit;
+            if (instance.blas->intersect_hit(object_ray, object_hit) && object_hit.t / t_scale < hit.t)
+            {
+                hit.t = object_hit.t / t_scale;
+                hit.triangle = object_hit.triangle;
+                // Normalen transformieren mit der Transponierten der Inversen
+                hit.normal = instance.world_to_object.apply_transposed(object_hit.normal).normalize();
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+bool InstancedScene::occluded(const Ray &ray, float t_max) const
+{
+    if (nodes.empty())
+        return false;
+
+    uint32_t stack[64];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const BVHNode &node = nodes[stack[--sp]];
+        float box_t_min, box_t_max;
+        if (!node.bbox.intersect(ray, box_t_min, box_t_max) || box_t_min > t_max)
+            continue;
+
+        if (!node.is_leaf())
+        {
+            stack[sp++] = node.left_first + 1;
+            stack[sp++] = node.left_first;
+            continue;
+        }
+
+        for (uint32_t i = node.left_first; i < node.left_first + node.count; ++i)
+        {
+            const Instance &instance = instances[instance_order[i]];
+            float t_scale;
+            Ray object_ray = to_object_space(instance, ray, t_scale);
+            if (instance.blas->occluded(object_ray, t_max * t_scale))
+                return true;
+        }
+    }
+    return false;
+}
+
+void InstancedScene::print_stats() const
+{
+    // Geteilte Strukturen nur einmal zählen
+    std::vector<const Accelerator *> unique_blas;
+    for (const auto &instance : instances)
+    {
+        if (std::find(unique_blas.begin(), unique_blas.end(), instance.blas) == unique_blas.end())
+            unique_blas.push_back(instance.blas);
+    }
+
+    std::cout << "Instanced Scene Statistics:\n";
+    std::cout << "  Instances: " << instances.size() << "\n";
+    std::cout << "  Unique meshes: " << unique_blas.size() << "\n";
+    std::cout << "  Top level nodes: " << nodes.size() << "\n";
+}
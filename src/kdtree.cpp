@@ -3,84 +3,6 @@
 #include <iostream>
 #include <cmath>
 
-// BoundingBox Implementation
-void BoundingBox::expand(const Point3 &point)
-{
-    min.x = std::min(min.x, point.x);
-    min.y = std::min(min.y, point.y);
-    min.z = std::min(min.z, point.z);
-    max.x = std::max(max.x, point.x);
-    max.y = std::max(max.y, point.y);
-    max.z = std::max(max.z, point.z);
-}
-
-void BoundingBox::expand(const BoundingBox &box)
-{
-    expand(box.min);
-    expand(box.max);
-}
-
-bool BoundingBox::intersect(const Ray &ray, float &t_min, float &t_max) const
-{
-    t_min = 0.0f;
-    t_max = 1e30f;
-
-    // Teste alle drei Achsen
-    for (int i = 0; i < 3; i++)
-    {
-        float ray_origin = (i == 0) ? ray.origin.x : (i == 1) ? ray.origin.y
-                                                              : ray.origin.z;
-        float ray_dir = (i == 0) ? ray.direction.x : (i == 1) ? ray.direction.y
-                                                              : ray.direction.z;
-        float box_min = (i == 0) ? min.x : (i == 1) ? min.y
-                                                    : min.z;
-        float box_max = (i == 0) ? max.x : (i == 1) ? max.y
-                                                    : max.z;
-
-        if (std::abs(ray_dir) < 1e-8f)
-        {
-            // Strahl ist parallel zur Achse
-            if (ray_origin < box_min || ray_origin > box_max)
-            {
-                return false;
-            }
-        }
-        else
-        {
-            // Berechne Schnittpunkte
-            float t1 = (box_min - ray_origin) / ray_dir;
-            float t2 = (box_max - ray_origin) / ray_dir;
-
-            if (t1 > t2)
-                std::swap(t1, t2);
-
-            t_min = std::max(t_min, t1);
-            t_max = std::min(t_max, t2);
-
-            if (t_min > t_max)
-                return false;
-        }
-    }
-
-    return t_max > 0.001f; // Mindest-Distanz
-}
-
-float BoundingBox::surface_area() const
-{
-    Vector3 d = max - min;
-    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
-}
-
-int BoundingBox::longest_axis() const
-{
-    Vector3 d = max - min;
-    if (d.x > d.y && d.x > d.z)
-        return 0;
-    if (d.y > d.z)
-        return 1;
-    return 2;
-}
-
 // KDTree Implementation
 KDTree::KDTree(int max_depth, int max_triangles_per_leaf)
     : max_depth(std::min(max_depth, 15)), max_triangles_per_leaf(std::max(max_triangles_per_leaf, 20))
@@ -355,6 +277,8 @@ bool KDTree::intersect(const Ray &ray, float &t, const Triangle *&hit_triangle)
 
 bool KDTree::intersect_recursive(const KDNode *node, const Ray &ray, float &min_t, const Triangle *&hit_triangle) const
 {
+    ++traversal_counters.nodes;
+
     // Bounding Box Test
     float t_min, t_max;
     if (!node->bbox.intersect(ray, t_min, t_max) || t_min > min_t)
@@ -367,6 +291,7 @@ bool KDTree::intersect_recursive(const KDNode *node, const Ray &ray, float &min_
     if (node->is_leaf)
     {
         // Blatt: Alle Dreiecke testen
+        traversal_counters.triangles += node->triangles.size();
         for (const Triangle *tri : node->triangles)
         {
             float t;
@@ -380,13 +305,15 @@ bool KDTree::intersect_recursive(const KDNode *node, const Ray &ray, float &min_
     }
     else
     {
-        // Innerer Knoten: Beide Kinder testen
-        // Vereinfachte Traversierung - teste beide Kinder
-        if (node->left && intersect_recursive(node->left.get(), ray, min_t, hit_triangle))
+        // Innerer Knoten: Beide Kinder testen, das nahe Kind zuerst.
+        // Ein früher Treffer verkleinert min_t und verwirft das ferne Kind.
+        const KDNode *near_child = ray.sign[node->axis] ? node->right.get() : node->left.get();
+        const KDNode *far_child = ray.sign[node->axis] ? node->left.get() : node->right.get();
+        if (near_child && intersect_recursive(near_child, ray, min_t, hit_triangle))
         {
             hit = true;
         }
-        if (node->right && intersect_recursive(node->right.get(), ray, min_t, hit_triangle))
+        if (far_child && intersect_recursive(far_child, ray, min_t, hit_triangle))
         {
             hit = true;
         }
@@ -395,6 +322,189 @@ bool KDTree::intersect_recursive(const KDNode *node, const Ray &ray, float &min_
     return hit;
 }
 
+bool KDTree::find_occluder(const Ray &ray, float t_max, const Triangle *&occluder) const
+{
+    occluder = nullptr;
+    return root && occluded_recursive(root.get(), ray, t_max, occluder);
+}
+
+bool KDTree::occluded_recursive(const KDNode *node, const Ray &ray, float t_max, const Triangle *&occluder) const
+{
+    ++traversal_counters.nodes;
+
+    float box_t_min, box_t_max;
+    if (!node->bbox.intersect(ray, box_t_min, box_t_max) || box_t_min > t_max)
+    {
+        return false;
+    }
+
+    if (node->is_leaf)
+    {
+        // Erster Treffer vor t_max genügt
+        for (const Triangle *tri : node->triangles)
+        {
+            ++traversal_counters.triangles;
+            float t;
+            if (tri->intersect(ray, t) && t < t_max && t > 0.001f)
+            {
+                occluder = tri;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const KDNode *near_child = ray.sign[node->axis] ? node->right.get() : node->left.get();
+    const KDNode *far_child = ray.sign[node->axis] ? node->left.get() : node->right.get();
+    return (near_child && occluded_recursive(near_child, ray, t_max, occluder)) ||
+           (far_child && occluded_recursive(far_child, ray, t_max, occluder));
+}
+
+void KDTree::intersect_stream(const RayStream &rays, HitStream &hits) const
+{
+    hits.resize(rays.size());
+    traverse_stream(rays, false, hits.t, hits.triangle);
+
+    // Strahlen ohne Treffer behalten t = 1e30
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        if (hits.triangle[i])
+            hits.normal[i] = hits.triangle[i]->normal();
+        else
+            hits.t[i] = 1e30f;
+    }
+}
+
+void KDTree::occluded_stream(const RayStream &rays, std::vector<char> &occluded) const
+{
+    // Schattenbündel kommen oft pro Treffer mit wenigen Strahlen, Puffer wiederverwenden
+    thread_local std::vector<const Triangle *> occluder;
+    occluder_stream(rays, occluded, occluder);
+}
+
+void KDTree::occluder_stream(const RayStream &rays, std::vector<char> &occluded,
+                             std::vector<const Triangle *> &occluders) const
+{
+    thread_local std::vector<float> best_t;
+    traverse_stream(rays, true, best_t, occluders);
+
+    // Der KD-Tree kennt zu jedem verdeckten Strahl das Dreieck
+    occluded.resize(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        occluded[i] = occluders[i] != nullptr;
+    }
+}
+
+void KDTree::traverse_stream(const RayStream &rays, bool any_hit, std::vector<float> &best_t,
+                             std::vector<const Triangle *> &best_triangle) const
+{
+    const size_t count = rays.size();
+    best_t.assign(rays.t_max.begin(), rays.t_max.end());
+    best_triangle.assign(count, nullptr);
+    if (!root || count == 0)
+        return;
+
+    // Strahlen einmal aufbereiten (Kehrwert und Vorzeichen)
+    thread_local std::vector<Ray> ray_data;
+    ray_data.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        ray_data.push_back(rays.ray(i));
+    }
+
+    // Nach Richtungsoktant sortieren, damit jede Gruppe dieselbe Nah-/Fern-Reihenfolge hat
+    auto octant = [&](size_t i)
+    {
+        const Ray &r = ray_data[i];
+        return r.sign[0] | (r.sign[1] << 1) | (r.sign[2] << 2);
+    };
+
+    size_t bucket_start[9] = {0};
+    for (size_t i = 0; i < count; ++i)
+    {
+        bucket_start[octant(i) + 1]++;
+    }
+    for (int o = 0; o < 8; ++o)
+    {
+        bucket_start[o + 1] += bucket_start[o];
+    }
+
+    thread_local std::vector<uint32_t> order;
+    order.resize(count);
+    size_t fill[8];
+    std::copy(bucket_start, bucket_start + 8, fill);
+    for (size_t i = 0; i < count; ++i)
+    {
+        order[fill[octant(i)]++] = static_cast<uint32_t>(i);
+    }
+
+    thread_local std::vector<std::vector<uint32_t>> scratch;
+    if (scratch.size() < static_cast<size_t>(max_depth + 2))
+        scratch.resize(max_depth + 2);
+    for (int o = 0; o < 8; ++o)
+    {
+        size_t n = bucket_start[o + 1] - bucket_start[o];
+        if (n > 0)
+        {
+            stream_recursive(root.get(), ray_data, order.data() + bucket_start[o], n, any_hit,
+                             best_t.data(), best_triangle.data(), scratch, 0);
+        }
+    }
+}
+
+void KDTree::stream_recursive(const KDNode *node, const std::vector<Ray> &rays, const uint32_t *active, size_t count,
+                              bool any_hit, float *best_t, const Triangle **best_triangle,
+                              std::vector<std::vector<uint32_t>> &scratch, int depth) const
+{
+    // Strahlen herausfiltern, die den Knoten verfehlen oder schon näher getroffen haben
+    std::vector<uint32_t> &survivors = scratch[depth];
+    survivors.resize(count);
+    size_t alive = 0;
+    for (size_t k = 0; k < count; ++k)
+    {
+        uint32_t i = active[k];
+        float t_min, t_max;
+        if (node->bbox.intersect(rays[i], t_min, t_max) && t_min <= best_t[i])
+        {
+            survivors[alive++] = i;
+        }
+    }
+    if (alive == 0)
+        return;
+
+    if (node->is_leaf)
+    {
+        // Jedes Dreieck wird einmal geladen und gegen alle Strahlen getestet
+        for (const Triangle *tri : node->triangles)
+        {
+            for (size_t k = 0; k < alive; ++k)
+            {
+                uint32_t i = survivors[k];
+                if (best_t[i] < 0.0f)
+                    continue; // Bereits verdeckt (any_hit)
+
+                float t;
+                if (tri->intersect(rays[i], t) && t < best_t[i] && t > 0.001f)
+                {
+                    best_triangle[i] = tri;
+                    best_t[i] = any_hit ? -1.0f : t;
+                }
+            }
+        }
+        return;
+    }
+
+    // Alle Strahlen der Gruppe liegen im selben Oktanten
+    const int sign = rays[survivors[0]].sign[node->axis];
+    const KDNode *near_child = sign ? node->right.get() : node->left.get();
+    const KDNode *far_child = sign ? node->left.get() : node->right.get();
+    if (near_child)
+        stream_recursive(near_child, rays, survivors.data(), alive, any_hit, best_t, best_triangle, scratch, depth + 1);
+    if (far_child)
+        stream_recursive(far_child, rays, survivors.data(), alive, any_hit, best_t, best_triangle, scratch, depth + 1);
+}
+
 void KDTree::print_stats() const
 {
     if (!root)
@@ -1,5 +1,9 @@
 #include "../include/light.hpp"
 #include "../include/geometry.hpp"
+#include "../include/raytracer.hpp"
+#include <algorithm>
+#include <iostream>
+#include <cmath>
 
 bool is_in_shadow(const Point3 &point, const Light &light, const std::vector<Triangle> &scene)
 {
@@ -16,4 +20,256 @@ bool is_in_shadow(const Point3 &point, const Light &light, const std::vector<Tri
         }
     }
     return false;
-}
\ No newline at end of file
+}
+
+// Light Implementation
+namespace
+{
+// Zerlegt n in ein möglichst quadratisches Raster nx * ny <= n
+void strata(int n, int &nx, int &ny)
+{
+    nx = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(n))));
+    ny = std::max(1, n / nx);
+}
+}
+
+Light Light::rectangle(const Point3 &center, const Vector3 &edge_u, const Vector3 &edge_v,
+                       const Vector3 &color, int samples)
+{
+    Light light{center, color};
+    light.shape = LightShape::Rectangle;
+    light.edge_u = edge_u;
+    light.edge_v = edge_v;
+    light.samples = samples;
+    return light;
+}
+
+Light Light::sphere(const Point3 &center, float radius, const Vector3 &color, int samples)
+{
+    Light light{center, color};
+    light.shape = LightShape::Sphere;
+    light.radius = radius;
+    light.samples = samples;
+    return light;
+}
+
+int Light::sample_count() const
+{
+    if (shape == LightShape::Point)
+        return 1;
+
+    int nx, ny;
+    strata(samples, nx, ny);
+    return nx * ny;
+}
+
+Point3 Light::sample_point(const Point3 &from, int index, uint32_t &rng) const
+{
+    if (shape == LightShape::Point)
+        return position;
+
+    int nx, ny;
+    strata(samples, nx, ny);
+    float s = ((index % nx) + random_float(rng)) / nx;
+    float t = ((index / nx) + random_float(rng)) / ny;
+
+    if (shape == LightShape::Rectangle)
+        return position + edge_u * (s - 0.5f) + edge_v * (t - 0.5f);
+
+    // Kugel: Kreisscheibe senkrecht zur Richtung zum Punkt, flächentreu abgebildet
+    Vector3 w = (from - position).normalize();
+    Vector3 helper = std::fabs(w.x) > 0.9f ? Vector3(0, 1, 0) : Vector3(1, 0, 0);
+    Vector3 u = helper.cross(w).normalize();
+    Vector3 v = w.cross(u);
+    float r = radius * std::sqrt(s);
+    float phi = 6.2831853f * t;
+    return position + u * (r * std::cos(phi)) + v * (r * std::sin(phi));
+}
+
+BoundingBox Light::bounds() const
+{
+    BoundingBox bbox;
+    switch (shape)
+    {
+    case LightShape::Point:
+        bbox.expand(position);
+        break;
+    case LightShape::Rectangle:
+        for (float a : {-0.5f, 0.5f})
+        {
+            for (float b : {-0.5f, 0.5f})
+                bbox.expand(position + edge_u * a + edge_v * b);
+        }
+        break;
+    case LightShape::Sphere:
+        bbox.expand(position - Vector3(radius, radius, radius));
+        bbox.expand(position + Vector3(radius, radius, radius));
+        break;
+    }
+    return bbox;
+}
+
+// LightTree Implementation
+namespace
+{
+float light_power(const Light &light)
+{
+    // Helligkeit der Lichtfarbe, weiß = 1
+    float luminance = (0.2126f * light.color.x + 0.7152f * light.color.y + 0.0722f * light.color.z) / 255.0f;
+    return light.intensity * luminance;
+}
+
+float distance_squared(const BoundingBox &bbox, const Point3 &point)
+{
+    float dist2 = 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float d = std::max({bbox.min[axis] - point[axis], 0.0f, point[axis] - bbox.max[axis]});
+        dist2 += d * d;
+    }
+    return dist2;
+}
+}
+
+void LightTree::build(const std::vector<Light> &new_lights)
+{
+    lights = new_lights;
+    nodes.clear();
+    if (lights.empty())
+        return;
+
+    nodes.reserve(2 * lights.size());
+    nodes.emplace_back();
+    build_recursive(0, 0, static_cast<uint32_t>(lights.size()));
+}
+
+void LightTree::build_recursive(uint32_t node_index, uint32_t first, uint32_t count)
+{
+    LightNode node;
+    node.power = 0.0f;
+    node.max_range = 0.0f;
+    node.left_first = first;
+    node.count = count;
+
+    bool unbounded = false;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        node.bbox.expand(lights[i].bounds());
+        node.power += light_power(lights[i]);
+        node.max_range = std::max(node.max_range, lights[i].range);
+        unbounded |= lights[i].range <= 0.0f;
+    }
+    // Ein Licht ohne Abfall macht den ganzen Teilbaum unbegrenzt
+    if (unbounded)
+        node.max_range = 0.0f;
+    nodes[node_index] = node;
+
+    if (count <= 1)
+        return;
+
+    // Median-Teilung entlang der längsten Achse, Blätter enthalten ein Licht
+    int axis = node.bbox.longest_axis();
+    uint32_t mid = first + count / 2;
+    std::nth_element(lights.begin() + first, lights.begin() + mid, lights.begin() + first + count,
+                     [axis](const Light &a, const Light &b)
+                     { return a.position[axis] < b.position[axis]; });
+
+    uint32_t left = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[node_index].left_first = left;
+    nodes[node_index].count = 0;
+
+    build_recursive(left, first, mid - first);
+    build_recursive(left + 1, mid, first + count - mid);
+}
+
+// Obere Schranke für den Beitrag eines Teilbaums: nächster Abstand zur Box
+// und größte Reichweite im Teilbaum
+float LightTree::importance(const LightNode &node, const Point3 &point) const
+{
+    if (node.max_range <= 0.0f)
+        return node.power;
+
+    float dist2 = distance_squared(node.bbox, point);
+    return node.power / (1.0f + dist2 / (node.max_range * node.max_range));
+}
+
+void LightTree::select(const Point3 &point, uint32_t &rng, std::vector<LightSample> &out) const
+{
+    out.clear();
+    if (nodes.empty())
+        return;
+
+    // Ein einzelnes Licht wird immer genommen
+    if (lights.size() == 1)
+    {
+        out.push_back({&lights[0], 1.0f});
+        return;
+    }
+
+    if (sample_count <= 0)
+    {
+        // Exakt: Teilbäume unter der Schwelle fallen komplett weg
+        uint32_t stack[64];
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0)
+        {
+            const LightNode &node = nodes[stack[--sp]];
+            if (importance(node, point) < min_contribution)
+                continue;
+
+            if (node.is_leaf())
+            {
+                for (uint32_t i = node.left_first; i < node.left_first + node.count; ++i)
+                    out.push_back({&lights[i], 1.0f});
+                continue;
+            }
+            stack[sp++] = node.left_first + 1;
+            stack[sp++] = node.left_first;
+        }
+        return;
+    }
+
+    // Stochastisch: Abstieg von der Wurzel, Kind proportional zur Wichtigkeit
+    for (int s = 0; s < sample_count; ++s)
+    {
+        uint32_t node_index = 0;
+        float pdf = 1.0f;
+        while (!nodes[node_index].is_leaf())
+        {
+            uint32_t left = nodes[node_index].left_first;
+            float importance_left = importance(nodes[left], point);
+            float importance_right = importance(nodes[left + 1], point);
+            float total = importance_left + importance_right;
+            float p_left = total > 0.0f ? importance_left / total : 0.5f;
+
+            if (random_float(rng) < p_left)
+            {
+                node_index = left;
+                pdf *= p_left;
+            }
+            else
+            {
+                node_index = left + 1;
+                pdf *= 1.0f - p_left;
+            }
+        }
+
+        const LightNode &leaf = nodes[node_index];
+        if (pdf > 0.0f)
+            out.push_back({&lights[leaf.left_first], 1.0f / (pdf * sample_count)});
+    }
+}
+
+void LightTree::print_stats() const
+{
+    std::cout << "Light Tree Statistics:\n";
+    std::cout << "  Lights: " << lights.size() << "\n";
+    std::cout << "  Nodes: " << nodes.size() << "\n";
+    std::cout << "  Mode: " << (sample_count > 0 ? "stochastic" : "exact");
+    if (sample_count > 0)
+        std::cout << " (" << sample_count << " samples)";
+    std::cout << "\n";
+}
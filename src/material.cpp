@@ -0,0 +1,48 @@
+#include "../include/material.hpp"
+#include <stdexcept>
+#include <limits>
+
+void MaterialTable::clear()
+{
+    materials.assign(1, Material(Vector3(255, 255, 255)));
+}
+
+uint16_t MaterialTable::add(const Material &material)
+{
+    if (materials.size() > std::numeric_limits<uint16_t>::max())
+        throw std::runtime_error("Zu viele Materialien (maximal 65536)");
+
+    materials.push_back(material);
+    return static_cast<uint16_t>(materials.size() - 1);
+}
+
+uint16_t MaterialTable::for_color(const Vector3 &color)
+{
+    const Material standard;
+    for (size_t i = 0; i < materials.size(); ++i)
+    {
+        const Material &m = materials[i];
+        if (m.name.empty() && m.color.x == color.x && m.color.y == color.y && m.color.z == color.z &&
+            m.ambient == standard.ambient && m.light_ambient == standard.light_ambient &&
+            m.diffuse == standard.diffuse && m.specular == standard.specular &&
+            m.shininess == standard.shininess && m.reflectivity == standard.reflectivity)
+            return static_cast<uint16_t>(i);
+    }
+    return add(Material(color));
+}
+
+int MaterialTable::find(const std::string &name) const
+{
+    for (size_t i = 0; i < materials.size(); ++i)
+    {
+        if (!name.empty() && materials[i].name == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+MaterialTable &material_table()
+{
+    static MaterialTable table;
+    return table;
+}
@@ -0,0 +1,493 @@
+#include "../include/png_stream.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <atomic>
+
+namespace
+{
+// Basislängen und Zusatzbits der Längen- und Distanzcodes (RFC 1951)
+const int length_base[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                           35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258, 259};
+const int length_extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const int distance_base[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                             257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577, 32768};
+const int distance_extra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                              7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+const int hash_bits = 15;
+const int window_size = 32768;
+const int max_match = 258;
+
+uint32_t reverse_bits(uint32_t code, int count)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < count; ++i, code >>= 1)
+        result = (result << 1) | (code & 1);
+    return result;
+}
+
+struct CrcTable
+{
+    uint32_t entries[256];
+
+    CrcTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+uint32_t crc32(uint32_t crc, const unsigned char *data, size_t size)
+{
+    // Mehrere Writer können gleichzeitig laufen, die Tabelle wird threadsicher angelegt
+    static const CrcTable table;
+    for (size_t i = 0; i < size; ++i)
+        crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+void put_be32(unsigned char *out, uint32_t value)
+{
+    out[0] = static_cast<unsigned char>(value >> 24);
+    out[1] = static_cast<unsigned char>(value >> 16);
+    out[2] = static_cast<unsigned char>(value >> 8);
+    out[3] = static_cast<unsigned char>(value);
+}
+
+int paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+uint32_t adler32(const unsigned char *data, size_t size)
+{
+    // In Portionen, in denen die Summen nicht überlaufen
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < size;)
+    {
+        size_t end = std::min(size, i + 5552);
+        for (; i < end; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Adler-32 zweier aufeinanderfolgender Abschnitte, length2 = Länge des zweiten
+uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t length2)
+{
+    const uint32_t base = 65521;
+    uint32_t remainder = static_cast<uint32_t>(length2 % base);
+    uint32_t sum1 = adler1 & 0xffff;
+    uint32_t sum2 = static_cast<uint32_t>((static_cast<uint64_t>(remainder) * sum1) % base);
+    sum1 += (adler2 & 0xffff) + base - 1;
+    sum2 += (adler1 >> 16) + (adler2 >> 16) + base - remainder;
+    if (sum1 >= base)
+        sum1 -= base;
+    if (sum1 >= base)
+        sum1 -= base;
+    if (sum2 >= 2 * base)
+        sum2 -= 2 * base;
+    if (sum2 >= base)
+        sum2 -= base;
+    return (sum2 << 16) | sum1;
+}
+
+// Bitweises Schreiben in einen Bytevektor, niederwertigstes Bit zuerst
+struct BitWriter
+{
+    std::vector<unsigned char> &out;
+    uint32_t buffer = 0;
+    int count = 0;
+
+    explicit BitWriter(std::vector<unsigned char> &out) : out(out) {}
+
+    void put_bits(uint32_t bits, int n)
+    {
+        buffer |= bits << count;
+        count += n;
+        while (count >= 8)
+        {
+            out.push_back(static_cast<unsigned char>(buffer & 0xff));
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    void align()
+    {
+        if (count > 0)
+            put_bits(0, 8 - count);
+    }
+
+    // Feste Huffman-Codes, werden mit dem höchsten Bit zuerst geschrieben
+    void put_huffman(int symbol)
+    {
+        if (symbol <= 143)
+            put_bits(reverse_bits(0x30 + symbol, 8), 8);
+        else if (symbol <= 255)
+            put_bits(reverse_bits(0x190 + symbol - 144, 9), 9);
+        else if (symbol <= 279)
+            put_bits(reverse_bits(symbol - 256, 7), 7);
+        else
+            put_bits(reverse_bits(0xc0 + symbol - 280, 8), 8);
+    }
+};
+
+int predict(int filter, int a, int b, int c)
+{
+    switch (filter)
+    {
+    case 1:
+        return a;
+    case 2:
+        return b;
+    case 3:
+        return (a + b) / 2;
+    case 4:
+        return paeth(a, b, c);
+    default:
+        return 0;
+    }
+}
+
+// Hängt die gefilterte Zeile (Filtertyp + Bytes) an out an. Wie stb_image_write
+// werden alle fünf Filter probiert und der mit der kleinsten Summe der Beträge
+// genommen; ohne Auswahl bleibt die Zeile ungefiltert.
+void filter_row(const unsigned char *row, const unsigned char *prior, int stride, bool choose,
+                std::vector<unsigned char> &out)
+{
+    int best_filter = 0;
+    long best_sum = -1;
+    for (int filter = 0; choose && filter < 5; ++filter)
+    {
+        long sum = 0;
+        for (int i = 0; i < stride; ++i)
+        {
+            int a = i >= 3 ? row[i - 3] : 0;
+            int c = i >= 3 ? prior[i - 3] : 0;
+            sum += std::abs(static_cast<signed char>(row[i] - predict(filter, a, prior[i], c)));
+        }
+        if (best_sum < 0 || sum < best_sum)
+        {
+            best_sum = sum;
+            best_filter = filter;
+        }
+    }
+
+    out.push_back(static_cast<unsigned char>(best_filter));
+    for (int i = 0; i < stride; ++i)
+    {
+        int a = i >= 3 ? row[i - 3] : 0;
+        int c = i >= 3 ? prior[i - 3] : 0;
+        out.push_back(static_cast<unsigned char>(row[i] - predict(best_filter, a, prior[i], c)));
+    }
+}
+
+// Ein Deflate-Block mit festen Huffman-Codes, LZ77 über Hash-Ketten
+void deflate_fixed(const unsigned char *data, int n, int max_chain, BitWriter &bits)
+{
+    thread_local std::vector<int> hash_head, hash_prev;
+    hash_head.assign(1 << hash_bits, -1);
+    hash_prev.resize(n);
+    auto hash = [data](int i)
+    {
+        uint32_t h = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+        return (h * 2654435761u) >> (32 - hash_bits);
+    };
+    auto insert = [&](int i)
+    {
+        uint32_t h = hash(i);
+        hash_prev[i] = hash_head[h];
+        hash_head[h] = i;
+    };
+
+    bits.put_bits(0, 1); // Nicht der letzte Block
+    bits.put_bits(1, 2); // Feste Huffman-Codes
+
+    int i = 0;
+    while (i < n)
+    {
+        int best_length = 0, best_distance = 0;
+        if (i + 3 <= n)
+        {
+            int limit = std::min(max_match, n - i);
+            int chain = 0;
+            for (int j = hash_head[hash(i)]; j >= 0 && i - j <= window_size && chain < max_chain; j = hash_prev[j], ++chain)
+            {
+                int length = 0;
+                while (length < limit && data[j + length] == data[i + length])
+                    ++length;
+                if (length > best_length)
+                {
+                    best_length = length;
+                    best_distance = i - j;
+                    if (length == limit)
+                        break;
+                }
+            }
+            insert(i);
+        }
+
+        if (best_length >= 3)
+        {
+            int code = 0;
+            while (length_base[code + 1] <= best_length)
+                ++code;
+            bits.put_huffman(257 + code);
+            if (length_extra[code])
+                bits.put_bits(best_length - length_base[code], length_extra[code]);
+
+            int dcode = 0;
+            while (dcode < 29 && distance_base[dcode + 1] <= best_distance)
+                ++dcode;
+            bits.put_bits(reverse_bits(dcode, 5), 5);
+            if (distance_extra[dcode])
+                bits.put_bits(best_distance - distance_base[dcode], distance_extra[dcode]);
+
+            for (int k = 1; k < best_length; ++k)
+            {
+                if (i + k + 3 <= n)
+                    insert(i + k);
+            }
+            i += best_length;
+        }
+        else
+        {
+            bits.put_huffman(data[i]);
+            ++i;
+        }
+    }
+    bits.put_huffman(256); // Blockende
+}
+
+// Unkomprimierte Blöcke (Stufe 0) bzw. ein leerer Block zum Ausrichten auf
+// die nächste Bytegrenze
+void deflate_stored(const unsigned char *data, size_t n, BitWriter &bits)
+{
+    size_t offset = 0;
+    do
+    {
+        size_t length = std::min<size_t>(n - offset, 65535);
+        bits.put_bits(0, 1); // Nicht der letzte Block
+        bits.put_bits(0, 2); // Stored
+        bits.align();
+        bits.out.push_back(static_cast<unsigned char>(length & 0xff));
+        bits.out.push_back(static_cast<unsigned char>(length >> 8));
+        bits.out.push_back(static_cast<unsigned char>(~length & 0xff));
+        bits.out.push_back(static_cast<unsigned char>((~length >> 8) & 0xff));
+        bits.out.insert(bits.out.end(), data + offset, data + offset + length);
+        offset += length;
+    } while (offset < n);
+}
+}
+
+struct PngStreamWriter::Strip
+{
+    std::vector<unsigned char> prior; // Ungefilterte Zeile über dem Streifen
+    std::vector<unsigned char> rows;  // Ungefilterte Zeilen des Streifens
+    int row_count = 0;
+
+    std::vector<unsigned char> compressed;
+    uint32_t adler = 1;
+    size_t filtered_length = 0;
+
+    // Genau einer komprimiert: der Pool-Thread oder der wartende Writer
+    std::atomic<bool> claimed{false};
+    bool claim() { return !claimed.exchange(true); }
+
+    void encode(int width, int level)
+    {
+        const int stride = width * 3;
+        thread_local std::vector<unsigned char> filtered;
+        filtered.clear();
+        filtered.reserve(static_cast<size_t>(row_count) * (stride + 1));
+        const unsigned char *above = prior.data();
+        for (int r = 0; r < row_count; ++r)
+        {
+            const unsigned char *row = &rows[static_cast<size_t>(r) * stride];
+            filter_row(row, above, stride, level > 0, filtered);
+            above = row;
+        }
+        adler = adler32(filtered.data(), filtered.size());
+        filtered_length = filtered.size();
+
+        BitWriter bits(compressed);
+        if (level <= 0)
+        {
+            deflate_stored(filtered.data(), filtered.size(), bits);
+            return;
+        }
+
+        // Stufe 1..9: 1 bis 256 Kandidaten pro Hash-Kette; danach ein leerer
+        // Stored-Block, damit der Streifen auf einer Bytegrenze endet
+        deflate_fixed(filtered.data(), static_cast<int>(filtered.size()), 1 << (std::min(level, 9) - 1), bits);
+        deflate_stored(nullptr, 0, bits);
+    }
+};
+
+PngStreamWriter::PngStreamWriter(const std::string &filename, int width, int height, const PngOptions &options)
+    : file(filename, std::ios::binary), filename(filename), width(width), height(height), options(options),
+      own_pool(options.pool ? nullptr : new ThreadPool(static_cast<size_t>(std::max(0, options.threads)))),
+      pool(options.pool ? options.pool : own_pool.get())
+{
+    this->options.rows_per_strip = std::max(1, options.rows_per_strip);
+    if (!file)
+        throw std::runtime_error("PNG-Datei konnte nicht geöffnet werden: " + filename);
+
+    // Signatur und Kopf: 8 Bit RGB, ohne Interlacing
+    static const unsigned char signature[8] = {137, 'P', 'N', 'G', 13, 10, 26, 10};
+    file.write(reinterpret_cast<const char *>(signature), 8);
+    unsigned char header[13];
+    put_be32(header, static_cast<uint32_t>(width));
+    put_be32(header + 4, static_cast<uint32_t>(height));
+    header[8] = 8;
+    header[9] = 2;
+    header[10] = header[11] = header[12] = 0;
+    write_chunk("IHDR", header, sizeof(header));
+
+    // zlib-Kopf: Deflate mit 32K-Fenster, geht mit dem ersten Streifen hinaus
+    chunk_prefix = {0x78, 0x01};
+    previous_row.assign(static_cast<size_t>(width) * 3, 0);
+}
+
+PngStreamWriter::~PngStreamWriter()
+{
+    if (!finished)
+    {
+        try
+        {
+            finish();
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+void PngStreamWriter::write_row(const unsigned char *rgb)
+{
+    if (finished || rows_written >= height)
+        throw std::runtime_error("Zu viele Zeilen für " + filename);
+
+    const size_t stride = static_cast<size_t>(width) * 3;
+    if (!current)
+    {
+        current = std::make_shared<Strip>();
+        current->prior = previous_row;
+        current->rows.reserve(stride * options.rows_per_strip);
+    }
+    current->rows.insert(current->rows.end(), rgb, rgb + stride);
+    ++current->row_count;
+    ++rows_written;
+
+    if (current->row_count == options.rows_per_strip)
+    {
+        previous_row.assign(rgb, rgb + stride);
+        submit_strip();
+    }
+}
+
+void PngStreamWriter::submit_strip()
+{
+    std::shared_ptr<Strip> strip = std::move(current);
+    int w = width, level = options.level;
+    std::future<void> done = pool->submit([strip, w, level]()
+                                          {
+                                              if (strip->claim())
+                                                  strip->encode(w, level);
+                                          });
+    in_flight.emplace_back(std::move(strip), std::move(done));
+
+    // Fertige Streifen gleich schreiben, bei zu vielen offenen auf den ältesten warten
+    while (!in_flight.empty() &&
+           (in_flight.size() > 2 * pool->size() ||
+            in_flight.front().second.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+    {
+        write_front_strip();
+    }
+}
+
+void PngStreamWriter::write_front_strip()
+{
+    Strip &strip = *in_flight.front().first;
+    if (strip.claim())
+        strip.encode(width, options.level);
+    else
+        in_flight.front().second.get();
+
+    adler = adler32_combine(adler, strip.adler, strip.filtered_length);
+
+    if (chunk_prefix.empty())
+    {
+        write_chunk("IDAT", strip.compressed.data(), strip.compressed.size());
+    }
+    else
+    {
+        chunk_prefix.insert(chunk_prefix.end(), strip.compressed.begin(), strip.compressed.end());
+        write_chunk("IDAT", chunk_prefix.data(), chunk_prefix.size());
+        chunk_prefix.clear();
+    }
+    in_flight.pop_front();
+}
+
+void PngStreamWriter::finish()
+{
+    if (finished)
+        return;
+    finished = true;
+
+    if (current)
+        submit_strip();
+    while (!in_flight.empty())
+        write_front_strip();
+
+    // Leerer letzter Block mit festen Codes (nur Blockende), dann Adler-32
+    std::vector<unsigned char> end = chunk_prefix;
+    end.push_back(0x03);
+    end.push_back(0x00);
+    unsigned char checksum[4];
+    put_be32(checksum, adler);
+    end.insert(end.end(), checksum, checksum + 4);
+    write_chunk("IDAT", end.data(), end.size());
+    write_chunk("IEND", nullptr, 0);
+    file.close();
+
+    if (rows_written != height)
+        throw std::runtime_error("PNG unvollständig: " + std::to_string(rows_written) + " von " +
+                                 std::to_string(height) + " Zeilen für " + filename);
+    if (!file)
+        throw std::runtime_error("Fehler beim Schreiben von " + filename);
+}
+
+void PngStreamWriter::write_chunk(const char type[4], const unsigned char *data, size_t size)
+{
+    unsigned char length[4], crc_bytes[4];
+    put_be32(length, static_cast<uint32_t>(size));
+    uint32_t crc = crc32(0xffffffffu, reinterpret_cast<const unsigned char *>(type), 4);
+    if (size > 0)
+        crc = crc32(crc, data, size);
+    put_be32(crc_bytes, crc ^ 0xffffffffu);
+
+    file.write(reinterpret_cast<const char *>(length), 4);
+    file.write(type, 4);
+    if (size > 0)
+        file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+    file.write(reinterpret_cast<const char *>(crc_bytes), 4);
+}
@@ -0,0 +1,107 @@
+#include "../include/progress.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+
+namespace
+{
+std::atomic<bool> quiet_mode{false};
+}
+
+void ProgressReporter::set_quiet(bool quiet)
+{
+    quiet_mode.store(quiet, std::memory_order_relaxed);
+}
+
+bool ProgressReporter::quiet()
+{
+    return quiet_mode.load(std::memory_order_relaxed);
+}
+
+ProgressReporter::ProgressReporter(const std::string &label, uint64_t total_units, double interval_seconds)
+    : label(label), total(std::max<uint64_t>(1, total_units)),
+      interval(std::max<long long>(10, static_cast<long long>(interval_seconds * 1000.0))),
+      start(std::chrono::steady_clock::now())
+{
+    if (!quiet())
+        reporter = std::thread(&ProgressReporter::report_loop, this);
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    finish();
+}
+
+double ProgressReporter::elapsed() const
+{
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+void ProgressReporter::report_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this]
+                          { return stopping; }))
+        print_line(false);
+}
+
+// Erwartet gesperrten mutex
+void ProgressReporter::print_line(bool final)
+{
+    uint64_t units = std::min(done.load(std::memory_order_relaxed), total);
+    double seconds = elapsed();
+    double fraction = static_cast<double>(units) / total;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1);
+    line << "\r" << label << ": " << std::setw(5) << 100.0 * fraction << " %";
+    uint64_t ray_count = rays_cast();
+    if (ray_count > 0 && seconds > 0.0)
+        line << " | " << std::setprecision(2) << ray_count / seconds / 1e6 << " Mio. Strahlen/s";
+    line << std::setprecision(1);
+    if (final)
+        line << " | " << seconds << " s";
+    else if (units > 0)
+        line << " | noch " << seconds * (1.0 - fraction) / fraction << " s";
+
+    // Reste einer längeren vorigen Zeile überschreiben
+    std::string text = line.str();
+    size_t length = text.size();
+    if (length < last_length)
+        text.append(last_length - length, ' ');
+    last_length = length;
+    std::cout << text << (final ? "\n" : "") << std::flush;
+    line_open = !final;
+}
+
+void ProgressReporter::log(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (line_open)
+    {
+        std::cout << "\n";
+        line_open = false;
+        last_length = 0;
+    }
+    std::cout << line << "\n";
+}
+
+void ProgressReporter::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finished)
+            return;
+        finished = true;
+        stopping = true;
+    }
+    wake.notify_all();
+    if (reporter.joinable())
+    {
+        reporter.join();
+        std::lock_guard<std::mutex> lock(mutex);
+        print_line(true);
+    }
+}
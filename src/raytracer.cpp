@@ -3,42 +3,190 @@
 #include <cmath>
 #include <algorithm>
 
+// OccluderCache Implementation
+namespace
+{
+thread_local OccluderCache occluder_cache;
+}
+
+void OccluderCache::reset(const Accelerator *owner)
+{
+    accel = owner;
+    std::fill(entries, entries + size, nullptr);
+}
+
+bool OccluderCache::test(const Ray &ray, float t_max)
+{
+    for (int k = 0; k < size && entries[k]; ++k)
+    {
+        float t;
+        if (entries[k]->intersect(ray, t) && t < t_max && t > 0.001f)
+        {
+            // Treffer nach vorne, der nächste Punkt wird wahrscheinlich ebenso verdeckt
+            std::rotate(entries, entries + k, entries + k + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void OccluderCache::insert(const Triangle *tri)
+{
+    const Triangle **end = std::find(entries, entries + size - 1, tri);
+    std::copy_backward(entries, end, end + 1);
+    entries[0] = tri;
+}
+
+OccluderCache &thread_occluder_cache(const Accelerator &accel)
+{
+    if (occluder_cache.accel != &accel)
+        occluder_cache.reset(&accel);
+    return occluder_cache;
+}
+
+void clear_occluder_cache()
+{
+    occluder_cache.reset(nullptr);
+}
+
+bool occluded_cached(const Accelerator &accel, const Ray &ray, float t_max)
+{
+    OccluderCache &cache = thread_occluder_cache(accel);
+    if (cache.test(ray, t_max))
+        return true;
+
+    const Triangle *occluder;
+    if (!accel.find_occluder(ray, t_max, occluder))
+        return false;
+    if (occluder)
+        cache.insert(occluder);
+    return true;
+}
+
 Vector3 compute_normal(const Triangle &tri)
 {
-    Vector3 edge1 = tri.v1 - tri.v0;
-    Vector3 edge2 = tri.v2 - tri.v0;
-    return edge1.cross(edge2).normalize();
+    return tri.normal();
 }
 
-Vector3 phong_shading(const Triangle &tri, const Point3 &hitpoint, const Vector3 &normal,
-                      const Camera &cam, const Light &light)
+Vector3 direct_lighting(const Triangle &tri, const Point3 &hitpoint, const Vector3 &normal,
+                        const Camera &cam, const Light &light)
 {
-    // Ambiente Beleuchtung
-    Vector3 ambient = tri.color * 0.3f;
+    const Material &material = get_material(tri);
+
+    // Beleuchteter Anteil der Umgebung, im Schatten bleibt nur material.ambient
+    Vector3 ambient = material.color * material.light_ambient;
 
     // Diffuse Beleuchtung
-    Vector3 to_light = (light.position - hitpoint).normalize();
+    Vector3 to_light = light.position - hitpoint;
+    float dist2 = to_light.dot(to_light);
+    to_light = to_light.normalize();
     float diff = std::max(0.0f, normal.dot(to_light));
-    Vector3 diffuse = tri.color * diff * 0.8f;
+    Vector3 diffuse = material.color * diff * material.diffuse;
 
     // Spekulare Beleuchtung
     Vector3 to_view = (cam.eye - hitpoint).normalize();
     Vector3 reflect_dir = (normal * 2.0f * normal.dot(to_light) - to_light).normalize();
-    float spec = std::pow(std::max(0.0f, reflect_dir.dot(to_view)), 32.0f);
-    Vector3 specular = light.color * spec * 0.5f;
+    float spec = std::pow(std::max(0.0f, reflect_dir.dot(to_view)), material.shininess);
+    Vector3 specular = light.color * spec * material.specular;
 
-    return ambient + diffuse + specular;
+    return (ambient + diffuse + specular) * (light.intensity * light.attenuation(dist2));
 }
 
-Vector3 trace(const Ray &ray, const std::vector<Triangle> &scene, const Camera &cam,
-              const Light &light, int depth)
+Vector3 phong_shading(const Triangle &tri, const Point3 &hitpoint, const Vector3 &normal,
+                      const Camera &cam, const Light &light)
 {
-    // Rekursionslimit für Reflexionen
-    if (depth > 3)
+    const Material &material = get_material(tri);
+    return material.color * material.ambient + direct_lighting(tri, hitpoint, normal, cam, light);
+}
+
+Vector3 shade_lights(const Triangle &tri, const Point3 &hitpoint, const Vector3 &normal,
+                     const Camera &cam, const LightTree &lights, const Accelerator &accel, uint32_t &rng)
+{
+    // Wird vor jeder Reflexion fertig benutzt, daher genügen Puffer pro Thread
+    thread_local std::vector<LightSample> selected;
+    thread_local RayStream shadow_rays;
+    thread_local std::vector<Vector3> contributions;
+    thread_local std::vector<char> occluded;
+    thread_local std::vector<const Triangle *> occluders;
+    lights.select(hitpoint, rng, selected);
+
+    // Schatten - nur ambiente Beleuchtung
+    const Material &material = get_material(tri);
+    Vector3 color = material.color * material.ambient;
+
+    // Alle Schattenstrahlen des Treffers (Lichter x Schichten) in einem Bündel.
+    // Strahlen, die ein Dreieck aus dem Verdecker-Cache trifft, fallen vorher weg.
+    OccluderCache &cache = thread_occluder_cache(accel);
+    shadow_rays.clear();
+    contributions.clear();
+    for (const LightSample &sample : selected)
     {
-        return {30, 60, 100}; // Hintergrundfarbe
+        Light light_point = *sample.light;
+        int n = sample.light->sample_count();
+        for (int k = 0; k < n; ++k)
+        {
+            light_point.position = sample.light->sample_point(hitpoint, k, rng);
+            Vector3 dir = (light_point.position - hitpoint).normalize();
+            float dist_to_light = (light_point.position - hitpoint).length();
+            Ray shadow_ray(hitpoint + dir * 0.001f, dir);
+            if (cache.test(shadow_ray, dist_to_light))
+                continue;
+
+            shadow_rays.push_back(shadow_ray, dist_to_light);
+            contributions.push_back(direct_lighting(tri, hitpoint, normal, cam, light_point) * (sample.weight / n));
+        }
+    }
+
+    // Ein einzelner Strahl braucht kein Bündel
+    if (shadow_rays.size() == 1)
+    {
+        occluded.resize(1);
+        occluders.resize(1);
+        occluded[0] = accel.find_occluder(shadow_rays.ray(0), shadow_rays.t_max[0], occluders[0]);
+    }
+    else if (shadow_rays.size() > 1)
+    {
+        accel.occluder_stream(shadow_rays, occluded, occluders);
     }
 
+    // Der Verdecker dient nur dem Cache; Instanzen melden verdeckt ohne Dreieck
+    for (size_t j = 0; j < contributions.size(); ++j)
+    {
+        if (!occluded[j])
+            color = color + contributions[j];
+        else if (occluders[j])
+            cache.insert(occluders[j]);
+    }
+    return color;
+}
+
+float path_survival(const PathSettings &settings, int next_depth, float reflected_weight, uint32_t &rng)
+{
+    // Rekursionslimit für Reflexionen
+    if (next_depth > settings.max_depth)
+        return 0.0f;
+    if (reflected_weight >= settings.min_weight)
+        return 1.0f;
+    if (!settings.russian_roulette)
+        return 0.0f;
+
+    // Überlebenswahrscheinlichkeit proportional zum Gewicht, der Ausgleich
+    // hebt das Gewicht überlebender Pfade wieder auf min_weight
+    float p = reflected_weight / settings.min_weight;
+    return random_float(rng) < p ? p : 0.0f;
+}
+
+Vector3 terminated_reflection(const PathSettings &settings, int next_depth)
+{
+    if (settings.russian_roulette && next_depth <= settings.max_depth)
+        return {0, 0, 0};
+    return {30, 60, 100}; // Hintergrundfarbe
+}
+
+Vector3 trace(const Ray &ray, const std::vector<Triangle> &scene, const Camera &cam,
+              const LightTree &lights, const PathSettings &settings, uint32_t &rng,
+              float weight, int depth)
+{
     // Nächste Schnittstelle finden
     float min_t = std::numeric_limits<float>::max();
     const Triangle *hit_tri = nullptr;
@@ -62,83 +210,102 @@ Vector3 trace(const Ray &ray, const std::vector<Triangle> &scene, const Camera &
     hit_point = ray.origin + ray.direction * t;
     // Normale berechnen und Beleuchtung
     Vector3 normal = compute_normal(*hit_tri);
-    Vector3 color;
 
-    if (is_in_shadow(hit_point, light, scene))
+    // Schatten - nur ambiente Beleuchtung, sonst Phong-Beitrag pro Licht
+    thread_local std::vector<LightSample> selected;
+    lights.select(hit_point, rng, selected);
+    const Material &material = get_material(*hit_tri);
+    Vector3 color = material.color * material.ambient;
+    for (const LightSample &sample : selected)
+    {
+        Light light_point = *sample.light;
+        int n = sample.light->sample_count();
+        for (int k = 0; k < n; ++k)
+        {
+            light_point.position = sample.light->sample_point(hit_point, k, rng);
+            if (!is_in_shadow(hit_point, light_point, scene))
+                color = color + direct_lighting(*hit_tri, hit_point, normal, cam, light_point) * (sample.weight / n);
+        }
+    }
+
+    // Nicht spiegelnde Materialien brauchen keinen Reflexionsstrahl
+    float reflectivity = material.reflectivity;
+    if (reflectivity <= 0.0f)
+        return color;
+
+    // Reflexion nur verfolgen, wenn sie noch sichtbar zum Pixel beiträgt
+    float reflected_weight = weight * reflectivity;
+    Vector3 reflection;
+    float survival = path_survival(settings, depth + 1, reflected_weight, rng);
+    if (survival > 0.0f)
     {
-        // Schatten - nur ambiente Beleuchtung
-        color = hit_tri->color * 0.2f;
+        Vector3 reflect_dir = ray.direction - normal * 2.0f * ray.direction.dot(normal);
+        Ray reflected_ray(hit_point + reflect_dir * 0.001f, reflect_dir);
+        reflection = trace(reflected_ray, scene, cam, lights, settings, rng,
+                           reflected_weight / survival, depth + 1) / survival;
     }
     else
     {
-        // Vollständige Phong-Beleuchtung
-        color = phong_shading(*hit_tri, hit_point, normal, cam, light);
+        reflection = terminated_reflection(settings, depth + 1);
     }
 
-    // Reflexion berechnen
-    Vector3 reflect_dir = ray.direction - normal * 2.0f * ray.direction.dot(normal);
-    Ray reflected_ray(hit_point + reflect_dir * 0.001f, reflect_dir);
-    Vector3 reflection = trace(reflected_ray, scene, cam, light, depth + 1);
-
     // Reflexion mit Grundfarbe mischen
-    float reflectivity = 0.3f;
     return color * (1.0f - reflectivity) + reflection * reflectivity;
 }
 
-bool is_in_shadow_kdtree(const Point3 &point, const Light &light, const KDTree &kdtree)
+bool is_in_shadow_kdtree(const Point3 &point, const Light &light, const Accelerator &accel)
 {
     Vector3 dir = (light.position - point).normalize();
     Ray shadow_ray(point + dir * 0.001f, dir);
     float dist_to_light = (light.position - point).length();
 
-    float t;
-    const Triangle *hit_triangle;
-    if (kdtree.intersect(shadow_ray, t, hit_triangle) && t < dist_to_light)
-    {
-        return true;
-    }
-    return false;
+    // Jeder Treffer vor dem Licht genügt, der nächste wird nicht gebraucht
+    return occluded_cached(accel, shadow_ray, dist_to_light);
 }
 
-Vector3 trace_kdtree(const Ray &ray, const KDTree &kdtree, const Camera &cam,
-                     const Light &light, int depth)
+Vector3 trace_kdtree(const Ray &ray, const Accelerator &accel, const Camera &cam,
+                     const LightTree &lights, const PathSettings &settings, uint32_t &rng,
+                     float weight, int depth)
 {
-    // Rekursionslimit für Reflexionen
-    if (depth > 3)
+    // Nächste Schnittstelle mit der Beschleunigungsstruktur finden
+    Hit hit;
+    if (!accel.intersect_hit(ray, hit))
     {
         return {30, 60, 100}; // Hintergrundfarbe
     }
+    return shade_hit(ray, hit, accel, cam, lights, settings, rng, weight, depth);
+}
 
-    // Nächste Schnittstelle mit KD-Tree finden
-    float min_t;
-    const Triangle *hit_tri = nullptr;
-
-    if (!kdtree.intersect(ray, min_t, hit_tri))
-    {
-        return {30, 60, 100}; // Hintergrundfarbe
-    }
+Vector3 shade_hit(const Ray &ray, const Hit &hit, const Accelerator &accel, const Camera &cam,
+                  const LightTree &lights, const PathSettings &settings, uint32_t &rng,
+                  float weight, int depth)
+{
+    const Triangle *hit_tri = hit.triangle;
+    Point3 hit_point = ray.origin + ray.direction * hit.t;
+    Vector3 normal = hit.normal;
+    Vector3 color = shade_lights(*hit_tri, hit_point, normal, cam, lights, accel, rng);
 
-    Point3 hit_point = ray.origin + ray.direction * min_t;
-    Vector3 normal = compute_normal(*hit_tri);
-    Vector3 color;
+    // Nicht spiegelnde Materialien brauchen keinen Reflexionsstrahl
+    float reflectivity = get_material(*hit_tri).reflectivity;
+    if (reflectivity <= 0.0f)
+        return color;
 
-    if (is_in_shadow_kdtree(hit_point, light, kdtree))
+    // Reflexion nur verfolgen, wenn sie noch sichtbar zum Pixel beiträgt
+    float reflected_weight = weight * reflectivity;
+    Vector3 reflection;
+    float survival = path_survival(settings, depth + 1, reflected_weight, rng);
+    if (survival > 0.0f)
     {
-        // Schatten - nur ambiente Beleuchtung
-        color = hit_tri->color * 0.2f;
+        Vector3 reflect_dir = ray.direction - normal * 2.0f * ray.direction.dot(normal);
+        Ray reflected_ray(hit_point + reflect_dir * 0.001f, reflect_dir);
+        reflection = trace_kdtree(reflected_ray, accel, cam, lights, settings, rng,
+                                  reflected_weight / survival, depth + 1) / survival;
     }
     else
     {
-        // Vollständige Phong-Beleuchtung
-        color = phong_shading(*hit_tri, hit_point, normal, cam, light);
+        reflection = terminated_reflection(settings, depth + 1);
     }
 
-    // Reflexion berechnen
-    Vector3 reflect_dir = ray.direction - normal * 2.0f * ray.direction.dot(normal);
-    Ray reflected_ray(hit_point + reflect_dir * 0.001f, reflect_dir);
-    Vector3 reflection = trace_kdtree(reflected_ray, kdtree, cam, light, depth + 1);
-
     // Reflexion mit Grundfarbe mischen
-    float reflectivity = 0.3f;
     return color * (1.0f - reflectivity) + reflection * reflectivity;
 }
@@ -1,74 +1,386 @@
 #include "../include/renderer.hpp"
 #include "../include/raytracer.hpp"
+#include "../include/progress.hpp"
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
-void Renderer::show_progress(int current, int total)
+void Renderer::render(const std::vector<Triangle> &scene, const Camera &cam,
+                      const LightTree &lights, Image &img)
 {
-    float percent = 100.0f * current / (total - 1);
-    int bars = static_cast<int>(percent / 2);
+    std::cout << "Rendering started...\n";
+    auto start = std::chrono::high_resolution_clock::now();
+    ProgressReporter progress("Ohne Struktur", height);
+    std::vector<float> dx(width), dy(width), dz(width);
 
-    std::cout << "\r[";
-    for (int i = 0; i < 50; ++i)
+    for (int y = 0; y < height; ++y)
     {
-        std::cout << (i < bars ? "█" : " ");
+        cam.row_directions(y, 0, width, dx.data(), dy.data(), dz.data());
+        for (int x = 0; x < width; ++x)
+        {
+            Ray ray = Ray::with_unit_direction(cam.eye, Vector3(dx[x], dy[x], dz[x]));
+            uint32_t rng = path_seed(y * width + x);
+            Vector3 color = trace(ray, scene, cam, lights, path_settings, rng);
+            img.set_pixel(x, y, Color(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z)));
+        }
+        progress.advance(1, width);
     }
-    std::cout << "] " << static_cast<int>(percent) << "%";
-    std::cout.flush();
+    progress.finish();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> render_time = end - start;
+
+    std::cout << "Renderzeit: " << render_time.count() << " Sekunden\n";
 }
 
-void Renderer::render(const std::vector<Triangle> &scene, const Camera &cam,
-                      const Light &light, Image &img)
+Vector3 Renderer::trace_pixel(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                              int x, int y, bool reuse_gbuffer, const Triangle *&hit_triangle)
 {
-    std::cout << "Rendering started...\n";
+    Ray ray = cam.get_ray(x, y);
+    uint32_t pixel = y * width + x;
+    uint32_t rng = path_seed(pixel);
+
+    Hit hit;
+    if (reuse_gbuffer)
+        gbuffer.load(pixel, hit);
+    else if (!accel.intersect_hit(ray, hit))
+        hit.triangle = nullptr;
+    if (use_gbuffer && !reuse_gbuffer)
+        gbuffer.store(pixel, hit);
+
+    hit_triangle = hit.triangle;
+    return hit.triangle ? shade_hit(ray, hit, accel, cam, lights, path_settings, rng)
+                        : Vector3(30, 60, 100); // Hintergrundfarbe
+}
+
+void Renderer::set_pixel_order(PixelOrder pixel_order, int tile_size)
+{
+    order = pixel_order;
+    order_tile = tile_size;
+    visit_order.clear();
+}
+
+const std::vector<uint32_t> &Renderer::pixels_in_order()
+{
+    if (visit_order.size() != static_cast<size_t>(width) * height)
+        visit_order = make_pixel_order(width, height, order, order_tile);
+    return visit_order;
+}
+
+bool Renderer::is_edge(int x, int y) const
+{
+    const int dx[4] = {-1, 1, 0, 0};
+    const int dy[4] = {0, 0, -1, 1};
+    size_t pixel = static_cast<size_t>(y) * width + x;
+    const Vector3 &color = first_colors[pixel];
+
+    for (int k = 0; k < 4; ++k)
+    {
+        int nx = x + dx[k], ny = y + dy[k];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height)
+            continue;
+
+        size_t neighbor = static_cast<size_t>(ny) * width + nx;
+        if (anti_alias.compare_triangles && first_triangles[neighbor] != first_triangles[pixel])
+            return true;
+
+        const Vector3 &other = first_colors[neighbor];
+        float diff = std::max({std::fabs(color.x - other.x), std::fabs(color.y - other.y), std::fabs(color.z - other.z)});
+        if (diff > anti_alias.color_threshold)
+            return true;
+    }
+    return false;
+}
+
+Vector3 Renderer::stratified_sum(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                                 int x, int y, int samples, int &count)
+{
+    // Geschichtete Samples auf einem nx * ny Raster, in jeder Zelle zufällig verschoben
+    int nx = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(samples))));
+    int ny = std::max(1, samples / nx);
+    uint32_t pixel = y * width + x;
+
+    Vector3 sum;
+    for (int k = 0; k < nx * ny; ++k)
+    {
+        uint32_t rng = path_seed(pixel, k + 1);
+        float sx = ((k % nx) + random_float(rng)) / nx;
+        float sy = ((k / nx) + random_float(rng)) / ny;
+        Ray ray = cam.get_ray(x, y, sx, sy);
+
+        Hit hit;
+        if (accel.intersect_hit(ray, hit))
+            sum = sum + shade_hit(ray, hit, accel, cam, lights, path_settings, rng);
+        else
+            sum = sum + Vector3(30, 60, 100); // Hintergrundfarbe
+    }
+    count = nx * ny;
+    return sum;
+}
+
+Vector3 Renderer::supersample_pixel(const Accelerator &accel, const Camera &cam, const LightTree &lights, int x, int y,
+                                    int &count)
+{
+    // Zusätzliche Samples zum Sample aus der Pixelmitte
+    Vector3 sum = first_colors[static_cast<size_t>(y) * width + x] +
+                  stratified_sum(accel, cam, lights, x, y, anti_alias.samples, count);
+    return sum / static_cast<float>(count + 1);
+}
+
+void Renderer::render_kdtree(const Accelerator &accel, const Camera &cam,
+                             const LightTree &lights, Image &img)
+{
+    std::cout << "Rendering with " << accel.name() << " started...\n";
     auto start = std::chrono::high_resolution_clock::now();
+    clear_occluder_cache();
 
-    for (int y = 0; y < height; ++y)
+    // Gültiger G-Buffer: Primärstrahlen entfallen, sonst wird er nebenbei gefüllt
+    bool reuse = use_gbuffer && gbuffer.matches(accel, cam, width, height);
+    if (use_gbuffer && !reuse)
+        gbuffer.reset(accel, cam, width, height);
+    if (reuse)
+        std::cout << "G-Buffer wiederverwendet\n";
+
+    // Erster Durchgang: ein Strahl durch jede Pixelmitte
+    const std::vector<uint32_t> &pixels = pixels_in_order();
+    first_colors.resize(pixels.size());
+    first_triangles.resize(pixels.size());
+    pixel_nodes.resize(pixels.size());
+    const TraversalCounters counters_before = traversal_counters;
+
+    // Fortschritt in Einheiten von width Pixeln; mit Kantenglättung zählt der
+    // zweite Durchgang noch einmal so viel
+    const uint64_t steps = (pixels.size() + width - 1) / width;
+    ProgressReporter progress(accel.name(), anti_alias.samples > 0 ? 2 * steps : steps);
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        uint32_t pixel = pixels[i];
+        uint64_t nodes_before = traversal_counters.nodes;
+        first_colors[pixel] = trace_pixel(accel, cam, lights, pixel % width, pixel / width, reuse, first_triangles[pixel]);
+        pixel_nodes[pixel] = static_cast<uint32_t>(traversal_counters.nodes - nodes_before);
+
+        if ((i + 1) % width == 0 || i + 1 == pixels.size())
+            progress.advance(1, (i % width) + 1);
+    }
+    std::chrono::duration<double> first_pass_time = std::chrono::high_resolution_clock::now() - start;
+    uint64_t total_nodes = traversal_counters.nodes - counters_before.nodes;
+    uint64_t total_triangles = traversal_counters.triangles - counters_before.triangles;
+
+    if (use_gbuffer)
+        gbuffer.mark_complete();
+
+    // Zweiter Durchgang: zusätzliche Samples nur an Kanten
+    size_t edge_pixels = 0;
+    uint64_t sample_rays = 0;
+    for (size_t i = 0; i < pixels.size(); ++i)
     {
-        // Fortschrittsanzeige alle paar Zeilen
-        if (y % (height / 50) == 0 || y == height - 1)
+        uint32_t pixel = pixels[i];
+        int x = pixel % width, y = pixel / width;
+        Vector3 color = first_colors[pixel];
+        if (anti_alias.samples > 0 && is_edge(x, y))
         {
-            show_progress(y, height);
+            int count;
+            color = supersample_pixel(accel, cam, lights, x, y, count);
+            sample_rays += count;
+            ++edge_pixels;
         }
+        img.set_pixel(x, y, Color(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z)));
 
-        for (int x = 0; x < width; ++x)
+        if (anti_alias.samples > 0 && ((i + 1) % width == 0 || i + 1 == pixels.size()))
         {
-            Ray ray = cam.get_ray(x, y);
-            Vector3 color = trace(ray, scene, cam, light);
-            img.set_pixel(x, y, Color(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z)));
+            progress.advance(1, sample_rays);
+            sample_rays = 0;
         }
     }
+    progress.finish();
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> render_time = end - start;
 
-    std::cout << "\nRenderzeit: " << render_time.count() << " Sekunden\n";
+    std::cout << accel.name() << " Renderzeit: " << render_time.count() << " Sekunden\n";
+    if (total_nodes > 0)
+    {
+        const char *order_name[] = {"zeilenweise", "Morton", "Hilbert"};
+        double pixel_count = static_cast<double>(pixels.size());
+        std::cout << "Traversierung (" << order_name[static_cast<int>(order)] << "): "
+                  << total_nodes / pixel_count << " Knoten und " << total_triangles / pixel_count
+                  << " Dreiecke pro Pixel, höchstens " << *std::max_element(pixel_nodes.begin(), pixel_nodes.end())
+                  << " Knoten; " << pixel_count / first_pass_time.count() / 1e6 << " Mio. Pixel/s im ersten Durchgang\n";
+    }
+    if (anti_alias.samples > 0)
+    {
+        std::cout << "Kantenglättung: " << edge_pixels << " Pixel ("
+                  << 100.0 * edge_pixels / (static_cast<double>(width) * height) << " %) mehrfach abgetastet\n";
+    }
 }
 
-void Renderer::render_kdtree(const KDTree &kdtree, const Camera &cam,
-                             const Light &light, Image &img)
+int Renderer::render_progressive(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                                 Image &img, const ProgressiveSettings &settings)
 {
-    std::cout << "Rendering with KD-Tree started...\n";
+    std::cout << "Progressive rendering with " << accel.name() << " started...\n";
     auto start = std::chrono::high_resolution_clock::now();
+    auto elapsed = [&start]()
+    {
+        std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - start;
+        return d.count();
+    };
+    clear_occluder_cache();
 
-    for (int y = 0; y < height; ++y)
+    AccumulationBuffer buffer(width, height);
+    const std::vector<uint32_t> &pixels = pixels_in_order();
+    int passes = 0;
+    bool out_of_time = false;
+
+    for (int pass = 0; pass < settings.max_passes && !out_of_time; ++pass)
     {
-        // Fortschrittsanzeige alle paar Zeilen
-        if (y % (height / 50) == 0 || y == height - 1)
+        double change = 0.0;
+        for (size_t i = 0; i < pixels.size(); ++i)
         {
-            show_progress(y, height);
+            // Zeitbudget alle width Pixel prüfen; der erste Durchgang läuft immer vollständig
+            if (i % width == 0 && pass > 0 && settings.time_budget > 0.0 && elapsed() > settings.time_budget)
+            {
+                out_of_time = true;
+                break;
+            }
+
+            int x = pixels[i] % width, y = pixels[i] / width;
+            // Erster Durchgang durch die Pixelmitte wie render_kdtree, danach zufällig verschoben
+            uint32_t rng = path_seed(y * width + x, pass);
+            Ray ray = pass == 0 ? cam.get_ray(x, y) : cam.get_ray(x, y, random_float(rng), random_float(rng));
+
+            Hit hit;
+            Vector3 color = accel.intersect_hit(ray, hit) ? shade_hit(ray, hit, accel, cam, lights, path_settings, rng)
+                                                          : Vector3(30, 60, 100); // Hintergrundfarbe
+
+            Vector3 before(buffer.mean(x, y, 0), buffer.mean(x, y, 1), buffer.mean(x, y, 2));
+            buffer.add_sample(x, y, color.x, color.y, color.z);
+            change += std::max({std::fabs(buffer.mean(x, y, 0) - before.x),
+                                std::fabs(buffer.mean(x, y, 1) - before.y),
+                                std::fabs(buffer.mean(x, y, 2) - before.z)});
         }
+        if (out_of_time)
+            break;
 
-        for (int x = 0; x < width; ++x)
+        passes = pass + 1;
+        change /= static_cast<double>(width) * height;
+        std::cout << "Durchgang " << passes << ": " << elapsed() << " s";
+        if (pass > 0)
+            std::cout << ", mittlere Änderung " << change;
+        std::cout << "\n";
+
+        if (settings.snapshot_interval > 0 && passes % settings.snapshot_interval == 0)
         {
-            Ray ray = cam.get_ray(x, y);
-            Vector3 color = trace_kdtree(ray, kdtree, cam, light);
-            img.set_pixel(x, y, Color(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z)));
+            // .pfm schreibt die ungerundeten Mittelwerte, sonst nach der Endung
+            const std::string &path = settings.snapshot_path;
+            if (path.size() > 4 && path.compare(path.size() - 4, 4, ".pfm") == 0)
+                buffer.save_pfm(path);
+            else
+            {
+                buffer.resolve(img);
+                img.save(path);
+            }
         }
+
+        // Konvergiert, wenn ein weiteres Sample das Bild kaum noch ändert
+        if (pass > 0 && settings.convergence > 0.0f && change < settings.convergence)
+            break;
     }
 
+    buffer.resolve(img);
+    std::cout << accel.name() << " Progressive Renderzeit: " << elapsed() << " Sekunden, "
+              << passes << " Durchgänge" << (out_of_time ? " (Zeitbudget erreicht)" : "") << "\n";
+    return passes;
+}
+
+void Renderer::render_region(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                             Image &img, const PixelRect &region, int samples)
+{
+    // Auf das Bild beschneiden
+    int x0 = std::max(0, region.x), y0 = std::max(0, region.y);
+    int x1 = std::min(width, region.x + region.width), y1 = std::min(height, region.y + region.height);
+    if (x1 <= x0 || y1 <= y0)
+        throw std::runtime_error("Bildausschnitt liegt außerhalb des Bildes");
+
+    // Bild in Ausschnittgröße: zugeschnitten schreiben, sonst an Ort und Stelle einsetzen
+    bool cropped = img.get_width() == region.width && img.get_height() == region.height;
+    if (!cropped && (img.get_width() != width || img.get_height() != height))
+        throw std::runtime_error("Bildgröße passt weder zum Ausschnitt noch zum ganzen Bild");
+
+    std::cout << "Rendering region " << (x1 - x0) << "x" << (y1 - y0) << " at (" << x0 << ", " << y0
+              << ") with " << accel.name() << " started...\n";
+    auto start = std::chrono::high_resolution_clock::now();
+    clear_occluder_cache();
+    ProgressReporter progress(accel.name(), y1 - y0);
+    std::vector<float> dx(x1 - x0), dy(x1 - x0), dz(x1 - x0);
+
+    for (int y = y0; y < y1; ++y)
+    {
+        cam.row_directions(y, x0, x1 - x0, dx.data(), dy.data(), dz.data());
+        for (int x = x0; x < x1; ++x)
+        {
+            // Ein Sample: Pixelmitte und Pfad-Startwert wie im ganzen Bild, die Pixel stimmen also überein
+            Vector3 color;
+            if (samples <= 1)
+            {
+                Ray ray = Ray::with_unit_direction(cam.eye, Vector3(dx[x - x0], dy[x - x0], dz[x - x0]));
+                uint32_t rng = path_seed(y * width + x);
+                Hit hit;
+                color = accel.intersect_hit(ray, hit) ? shade_hit(ray, hit, accel, cam, lights, path_settings, rng)
+                                                      : Vector3(30, 60, 100); // Hintergrundfarbe
+            }
+            else
+            {
+                int count;
+                color = stratified_sum(accel, cam, lights, x, y, samples, count) / static_cast<float>(count);
+            }
+
+            Color pixel(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z));
+            if (cropped)
+                img.set_pixel(x - region.x, y - region.y, pixel);
+            else
+                img.set_pixel(x, y, pixel);
+        }
+        progress.advance(1, static_cast<uint64_t>(x1 - x0) * std::max(1, samples));
+    }
+    progress.finish();
+
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> render_time = end - start;
+    std::cout << accel.name() << " Ausschnitt Renderzeit: " << render_time.count() << " Sekunden\n";
+}
+
+void Renderer::render_to_png(const Accelerator &accel, const Camera &cam, const LightTree &lights,
+                             const std::string &filename, const PngOptions &options)
+{
+    std::cout << "Streaming rendering with " << accel.name() << " to " << filename << " started...\n";
+    auto start = std::chrono::high_resolution_clock::now();
+    clear_occluder_cache();
+
+    PngStreamWriter writer(filename, width, height, options);
+    std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+    ProgressReporter progress(accel.name(), height);
+    std::vector<float> dx(width), dy(width), dz(width);
+    for (int y = height - 1; y >= 0; --y)
+    {
+        cam.row_directions(y, 0, width, dx.data(), dy.data(), dz.data());
+        for (int x = 0; x < width; ++x)
+        {
+            Ray ray = Ray::with_unit_direction(cam.eye, Vector3(dx[x], dy[x], dz[x]));
+            uint32_t rng = path_seed(y * width + x);
+            Vector3 color = trace_kdtree(ray, accel, cam, lights, path_settings, rng);
+            Color c(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z));
+            row[3 * x] = c.r;
+            row[3 * x + 1] = c.g;
+            row[3 * x + 2] = c.b;
+        }
+        writer.write_row(row.data());
+        progress.advance(1, width);
+    }
+    writer.finish();
+    progress.finish();
 
-    std::cout << "\nKD-Tree Renderzeit: " << render_time.count() << " Sekunden\n";
+    std::chrono::duration<double> render_time = std::chrono::high_resolution_clock::now() - start;
+    std::cout << accel.name() << " Renderzeit (Streaming): " << render_time.count() << " Sekunden\n";
 }
@@ -0,0 +1,101 @@
+#include "../include/thread_pool.hpp"
+#include <atomic>
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+    workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i)
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::worker_loop()
+{
+    for (;;)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]
+                      { return stopping || !tasks.empty(); });
+            // Beim Beenden werden noch wartende Aufgaben abgearbeitet
+            if (tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task)
+{
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> result = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(packaged));
+    }
+    wake.notify_one();
+    return result;
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)> &body)
+{
+    std::atomic<size_t> next(0);
+    auto run = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+            body(i);
+    };
+
+    // Ein Helfer pro Arbeiter; Helfer, die erst nach dem Ende drankommen, finden nichts mehr
+    std::vector<std::future<void>> helpers;
+    size_t helper_count = std::min(workers.size(), count > 0 ? count - 1 : 0);
+    helpers.reserve(helper_count);
+    for (size_t i = 0; i < helper_count; ++i)
+        helpers.push_back(submit(run));
+
+    // Die Helfer greifen auf next und run zu, daher auch bei einer Ausnahme auf sie warten
+    std::exception_ptr error;
+    try
+    {
+        run();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        next = count;
+    }
+    for (std::future<void> &helper : helpers)
+    {
+        helper.wait();
+        if (!error)
+        {
+            try
+            {
+                helper.get();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
@@ -0,0 +1,273 @@
+#include "../include/wavefront.hpp"
+#include "../include/raytracer.hpp"
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+
+namespace
+{
+const Vector3 background = {30, 60, 100};
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+}
+
+// PathQueue Implementation
+void PathQueue::clear()
+{
+    rays.clear();
+    pixel.clear();
+    weight.clear();
+}
+
+void PathQueue::reserve(size_t n)
+{
+    rays.reserve(n);
+    pixel.reserve(n);
+    weight.reserve(n);
+}
+
+void PathQueue::push_back(const Ray &ray, uint32_t pixel_index, float path_weight)
+{
+    rays.push_back(ray);
+    pixel.push_back(pixel_index);
+    weight.push_back(path_weight);
+}
+
+// WavefrontRenderer Implementation
+WavefrontRenderer::WavefrontRenderer(int w, int h, size_t queue_size)
+    : width(w), height(h), queue_size(std::max<size_t>(queue_size, 1))
+{
+}
+
+void WavefrontRenderer::generate(const Camera &cam, uint32_t first_pixel, uint32_t count)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    radiance.assign(count, Vector3(0, 0, 0));
+
+    // Richtungen zeilenweise direkt aus der Kamera in die SoA-Warteschlange
+    RayStream &rays = current.rays;
+    rays.ox.assign(count, cam.eye.x);
+    rays.oy.assign(count, cam.eye.y);
+    rays.oz.assign(count, cam.eye.z);
+    rays.dx.resize(count);
+    rays.dy.resize(count);
+    rays.dz.resize(count);
+    rays.t_max.assign(count, 1e30f);
+    current.pixel.resize(count);
+    current.weight.assign(count, 1.0f);
+
+    for (uint32_t i = 0; i < count;)
+    {
+        uint32_t pixel = first_pixel + i;
+        int x = pixel % width, y = pixel / width;
+        uint32_t n = std::min<uint32_t>(count - i, width - x);
+        cam.row_directions(y, x, static_cast<int>(n), &rays.dx[i], &rays.dy[i], &rays.dz[i]);
+        for (uint32_t k = 0; k < n; ++k)
+            current.pixel[i + k] = pixel + k;
+        i += n;
+    }
+
+    timings.generate += seconds_since(start);
+}
+
+void WavefrontRenderer::extend(const Accelerator &accel, uint32_t first_pixel, int depth, bool reuse_gbuffer)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Primärstrahlen liegen in Pixelreihenfolge, der G-Buffer-Abschnitt passt direkt
+    if (depth == 0 && reuse_gbuffer)
+    {
+        gbuffer.load(first_pixel, static_cast<uint32_t>(current.size()), hits);
+    }
+    else
+    {
+        accel.intersect_stream(current.rays, hits);
+        if (depth == 0 && use_gbuffer)
+            gbuffer.store(first_pixel, hits);
+    }
+
+    timings.extend += seconds_since(start);
+}
+
+void WavefrontRenderer::shadow(const Accelerator &accel, const Camera &cam, const LightTree &lights, int depth)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Pro Treffer ein Schattenstrahl je gewähltem Licht. Bei vielen Lichtern wird
+    // in Portionen von queue_size Strahlen geprüft, damit der Speicher begrenzt bleibt.
+    // Strahlen, die ein Dreieck aus dem Verdecker-Cache trifft, kommen nicht in die Warteschlange.
+    OccluderCache &cache = thread_occluder_cache(accel);
+    direct.assign(current.size(), Vector3(0, 0, 0));
+    for (size_t i = 0; i < current.size(); ++i)
+    {
+        const Triangle *hit_tri = hits.triangle[i];
+        if (!hit_tri)
+            continue;
+
+        Point3 hit_point(current.rays.ox[i] + current.rays.dx[i] * hits.t[i],
+                         current.rays.oy[i] + current.rays.dy[i] * hits.t[i],
+                         current.rays.oz[i] + current.rays.dz[i] * hits.t[i]);
+
+        uint32_t rng = path_seed(current.pixel[i], 2 * depth);
+        lights.select(hit_point, rng, selected_lights);
+        for (const LightSample &sample : selected_lights)
+        {
+            // Flächenlichter liefern mehrere geschichtete Lichtpunkte
+            Light light_point = *sample.light;
+            int n = sample.light->sample_count();
+            for (int k = 0; k < n; ++k)
+            {
+                light_point.position = sample.light->sample_point(hit_point, k, rng);
+                Vector3 dir = (light_point.position - hit_point).normalize();
+                float dist_to_light = (light_point.position - hit_point).length();
+                Ray shadow_ray(hit_point + dir * 0.001f, dir);
+                if (cache.test(shadow_ray, dist_to_light))
+                    continue;
+
+                shadow_rays.push_back(shadow_ray, dist_to_light);
+                shadow_path.push_back(static_cast<uint32_t>(i));
+                shadow_contribution.push_back(direct_lighting(*hit_tri, hit_point, hits.normal[i], cam, light_point) *
+                                              (sample.weight / n));
+                if (shadow_rays.size() >= queue_size)
+                    flush_shadow_rays(accel);
+            }
+        }
+    }
+    flush_shadow_rays(accel);
+
+    timings.shadow += seconds_since(start);
+}
+
+void WavefrontRenderer::flush_shadow_rays(const Accelerator &accel)
+{
+    if (shadow_rays.size() == 0)
+        return;
+
+    OccluderCache &cache = thread_occluder_cache(accel);
+    accel.occluder_stream(shadow_rays, shadow_occluded, shadow_occluders);
+    for (size_t j = 0; j < shadow_rays.size(); ++j)
+    {
+        if (!shadow_occluded[j])
+            direct[shadow_path[j]] = direct[shadow_path[j]] + shadow_contribution[j];
+        else if (shadow_occluders[j])
+            cache.insert(shadow_occluders[j]);
+    }
+
+    shadow_rays.clear();
+    shadow_path.clear();
+    shadow_contribution.clear();
+}
+
+void WavefrontRenderer::shade(uint32_t first_pixel, int depth)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    next.clear();
+    for (size_t i = 0; i < current.size(); ++i)
+    {
+        Vector3 &pixel_radiance = radiance[current.pixel[i] - first_pixel];
+        float weight = current.weight[i];
+
+        const Triangle *hit_tri = hits.triangle[i];
+        if (!hit_tri)
+        {
+            pixel_radiance = pixel_radiance + background * weight;
+            continue;
+        }
+
+        // Schatten - nur ambiente Beleuchtung, dazu alle sichtbaren Lichter
+        const Material &material = get_material(*hit_tri);
+        Vector3 color = material.color * material.ambient + direct[i];
+        float reflectivity = material.reflectivity;
+        if (reflectivity <= 0.0f)
+        {
+            // Nicht spiegelnd: der Pfad endet hier
+            pixel_radiance = pixel_radiance + color * weight;
+            continue;
+        }
+        pixel_radiance = pixel_radiance + color * (weight * (1.0f - reflectivity));
+
+        // Reflexion nur verfolgen, wenn sie noch sichtbar zum Pixel beiträgt
+        float reflected_weight = weight * reflectivity;
+        uint32_t rng = path_seed(current.pixel[i], 2 * depth + 1);
+        float survival = path_survival(path_settings, depth + 1, reflected_weight, rng);
+        if (survival == 0.0f)
+        {
+            pixel_radiance = pixel_radiance + terminated_reflection(path_settings, depth + 1) * reflected_weight;
+            continue;
+        }
+
+        Vector3 direction(current.rays.dx[i], current.rays.dy[i], current.rays.dz[i]);
+        Point3 hit_point(current.rays.ox[i] + direction.x * hits.t[i],
+                         current.rays.oy[i] + direction.y * hits.t[i],
+                         current.rays.oz[i] + direction.z * hits.t[i]);
+        const Vector3 &normal = hits.normal[i];
+        Vector3 reflect_dir = direction - normal * 2.0f * direction.dot(normal);
+        next.push_back(Ray(hit_point + reflect_dir * 0.001f, reflect_dir), current.pixel[i],
+                       reflected_weight / survival);
+    }
+
+    // Nur noch aktive Pfade laufen weiter
+    std::swap(current, next);
+
+    timings.shade += seconds_since(start);
+}
+
+void WavefrontRenderer::render(const Accelerator &accel, const Camera &cam, const LightTree &lights, Image &img)
+{
+    std::cout << "Wavefront rendering with " << accel.name() << " started...\n";
+    auto start = std::chrono::high_resolution_clock::now();
+
+    timings = WavefrontTimings();
+    clear_occluder_cache();
+    current.reserve(queue_size);
+    next.reserve(queue_size);
+
+    bool reuse = use_gbuffer && gbuffer.matches(accel, cam, width, height);
+    if (use_gbuffer && !reuse)
+        gbuffer.reset(accel, cam, width, height);
+    if (reuse)
+        std::cout << "G-Buffer wiederverwendet\n";
+
+    const uint32_t pixel_count = static_cast<uint32_t>(width) * static_cast<uint32_t>(height);
+    for (uint32_t first = 0; first < pixel_count; first += static_cast<uint32_t>(queue_size))
+    {
+        uint32_t count = std::min<uint32_t>(static_cast<uint32_t>(queue_size), pixel_count - first);
+
+        generate(cam, first, count);
+        for (int depth = 0; current.size() > 0; ++depth)
+        {
+            extend(accel, first, depth, reuse);
+            shadow(accel, cam, lights, depth);
+            shade(first, depth);
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const Vector3 &color = radiance[i];
+            img.set_pixel((first + i) % width, (first + i) / width,
+                          Color(static_cast<int>(color.x), static_cast<int>(color.y), static_cast<int>(color.z)));
+        }
+    }
+
+    if (use_gbuffer)
+        gbuffer.mark_complete();
+
+    std::chrono::duration<double> render_time = std::chrono::high_resolution_clock::now() - start;
+    std::cout << accel.name() << " Wavefront Renderzeit: " << render_time.count() << " Sekunden\n";
+    print_timings();
+}
+
+void WavefrontRenderer::print_timings() const
+{
+    std::cout << "Wavefront Stufen:\n";
+    std::cout << "  Generate: " << timings.generate << " s\n";
+    std::cout << "  Extend:   " << timings.extend << " s\n";
+    std::cout << "  Shadow:   " << timings.shadow << " s\n";
+    std::cout << "  Shade:    " << timings.shade << " s\n";
+}